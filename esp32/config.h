@@ -50,16 +50,148 @@
 // {"type":"status","data":{"state":"...", "project":"...", "model":"...", ...}}
 #define JSON_BUFFER_SIZE 1024
 
+// Batched status payloads: [{...}, {...}] in one POST /status body or WS frame.
+// Payloads too large for JSON_BUFFER_SIZE are parsed into a shared static document.
+#define MAX_BATCH_ITEMS        16
+#define JSON_BATCH_BUFFER_SIZE 4096
+
+// Status lane: admitted updates wait here until loop() applies them before rendering.
+// Consecutive updates for the same project are merged into one entry.
+#define STATUS_QUEUE_SIZE 8
+
+// Token-bucket admission for status updates (commands are never limited).
+// Rate in updates/second and burst size, per source; rate 0 disables the limit.
+// Sources: Serial (one), HTTP and UDP (per remote IP), WebSocket (per connection).
+#define RATE_LIMIT_SERIAL_RATE  50
+#define RATE_LIMIT_SERIAL_BURST 100
+#define RATE_LIMIT_HTTP_RATE    10
+#define RATE_LIMIT_HTTP_BURST   20
+#define RATE_LIMIT_WS_RATE      20
+#define RATE_LIMIT_WS_BURST     40
+#define RATE_LIMIT_UDP_RATE     10
+#define RATE_LIMIT_UDP_BURST    20
+#define RATE_LIMIT_SOURCES       8   // Buckets tracked at once (least recent recycled)
+
+// Buffer size for the metrics JSON (Serial "metrics" command and GET /metrics)
+#define METRICS_JSON_SIZE 1536
+
+// Buffer size for the status JSON (Serial "status" command and GET /status):
+// fits two project names of control characters (escaped as \u00XX)
+#define STATUS_JSON_SIZE 512
+
 // Project lock modes
 #define LOCK_MODE_FIRST_PROJECT 0
 #define LOCK_MODE_ON_THINKING 1
-#define MAX_PROJECTS 10
+
+// Project table: interned names with stable IDs, least recently used evicted.
+// The locked project is never evicted. Range 2-254 (IDs are uint8_t).
+#define MAX_PROJECTS         32
+#define PROJECT_HASH_BUCKETS 64   // Power of 2, ~2x MAX_PROJECTS
+
+// View modes (single project full screen, multi-project dashboard, or
+// single-project screen rotating through active projects)
+#define VIEW_MODE_SINGLE    0
+#define VIEW_MODE_DASHBOARD 1
+#define VIEW_MODE_ROTATION  2
+
+// Dashboard: one tile per row for the most recently active projects,
+// each with a cached mini character sprite (scaled down from 128x128)
+#define DASHBOARD_TILES     6    // Rows on screen (max 8: tile must fit the mini sprite)
+#define DASHBOARD_MINI_SIZE 32   // Mini character sprite (px, square)
+
+// Rotation: each active project is shown for a dwell period. The next
+// project's screen is composed off-screen in a full-screen sprite (~110KB,
+// allocated only in rotation mode) and pushed in one go at the switch.
+// Next project: longest wait since last shown, plus a head start by state,
+// minus half the time since its last update.
+#define ROTATION_DWELL_MS         8000    // Time each project stays on screen
+#define ROTATION_PRECOMPOSE_MS    1000    // Compose the next screen this long before the switch
+#define ROTATION_ACTIVE_MS        600000  // Projects updated within this window take part (10 min)
+#define ROTATION_URGENT_BONUS_MS  600000  // alert, notification: ahead of all others
+#define ROTATION_ACTIVE_BONUS_MS  30000   // thinking, planning, working, packing
+
+// Settings store: one CRC-checked NVS blob cached in RAM. Changes are
+// coalesced and written from loop(), never from request handlers.
+#define SETTINGS_FLUSH_DELAY_MS    2000    // Write once no change for this long...
+#define SETTINGS_MIN_INTERVAL_MS   30000   // ...at most this often (flash wear)
+
+// Session snapshot (lock, screen, recent projects) restored at boot. The RTC
+// memory copy survives soft resets (reboot, crash, watchdog); the NVS copy
+// survives power loss and is written only after changes settle.
+#define SESSION_PROJECTS             8       // Most recently used projects kept
+#define SESSION_RTC_INTERVAL_MS      1000    // Check for changes, update the RTC copy
+#define SESSION_NVS_QUIET_MS         10000   // NVS write once no change for this long...
+#define SESSION_NVS_MIN_INTERVAL_MS  60000   // ...at most this often (flash wear)
+#define SESSION_NVS_MAX_DELAY_MS     300000  // Write anyway if changing for this long
+
+// History: ring log of state transitions (8 bytes each) and per-project
+// aggregates, served by GET /stats and the Serial "stats" command
+#define HISTORY_RECORDS 256   // Transitions kept (oldest overwritten)
+#define HISTORY_TOOLS   16    // Distinct tool names counted (the last one is "other")
+#define HTTP_CHUNK_SIZE 512   // GET /stats is streamed in chunks of this size
+
+// Latency probes: status updates with a "probe" ID are timed to the panel
+// flush (Serial "latency" command, GET /latency)
+#define LATENCY_RESULTS 32   // Recent probe results kept
+
+// Event tracer (only with USE_TRACE, see trace.h): 8 bytes per event
+#define TRACE_EVENTS 1024   // Power of 2
+
+// Duplicate status suppression (same event delivered over HTTP and WebSocket)
+#define DEDUP_WINDOW_SIZE 16     // Recent event keys remembered
+#define DEDUP_HORIZON_MS  3000   // Keys older than this never match
+
+// Status API HTTP server (see http_server.h): connections served at once,
+// each with its own preallocated buffers. Further clients wait in the TCP
+// backlog (or take over the longest-idle keep-alive connection).
+#define HTTP_MAX_CONNECTIONS         4
+#define HTTP_BODY_SIZE               4096    // Largest request body (a full batch), 413 above
+#define HTTP_REQUEST_TIMEOUT_MS      5000    // Close a connection stalled mid-request (408)
+#define HTTP_KEEPALIVE_TIMEOUT_MS    15000   // Close a persistent connection idle this long
+#define HTTP_KEEPALIVE_MAX_REQUESTS  1000    // Requests per connection before it is closed
+#define HTTP_MAX_WATCHERS            2       // Long polls + event streams at once (503 above)
+#define HTTP_LONG_POLL_MAX_MS        30000   // Longest GET /status?wait=
+#define HTTP_SSE_PING_MS             15000   // Comment line on an idle event stream
+#define HTTP_WRITE_TIMEOUT_MS        250     // A write to a client that stopped reading gives up (dropped)
+
+// UDP status ingest (only with USE_UDP, see udp_status.h)
+#define UDP_STATUS_PORT      19280
+#define UDP_PACKET_SIZE      1460    // Largest datagram accepted (one Ethernet frame)
+#define UDP_PACKETS_PER_LOOP 8       // Datagrams handled per loop() pass
+#define UDP_SENDERS          8       // Senders whose sequence number is tracked (least recent recycled)
+#define UDP_SEQ_RESET_MS     60000   // A sender silent this long may restart its sequence (not with UDP_SECRET)
+
+// LAN WebSocket server (only with USE_WS_SERVER, see ws_server.h). Clients
+// at once: WEBSOCKETS_SERVER_CLIENT_MAX of the WebSockets library.
+#define WS_SERVER_PORT             81
+#define WS_SERVER_PING_MS          30000   // Ping idle clients this often
+#define WS_SERVER_PONG_TIMEOUT_MS  10000
+#define WS_SERVER_PING_FAILURES    2       // Missed pongs before the client is dropped
+#define WS_SERVER_REPLY_SIZE       2048    // Longest command reply line sent to a client
+
+// State pushes to watchers (status_watch.h): displayed status as JSON.
+// Fits four 31-character names of control characters (escaped as \u00XX).
+#define STATUS_EVENT_SIZE 1024
 
 // WiFi connection
-#define WIFI_CONNECT_ATTEMPTS  20  // Max connection attempts per round
-#define WIFI_CONNECT_DELAY_MS 500  // Delay between each attempt (ms)
+// (non-blocking: loop() keeps running while it connects, see wifi_manager.h)
+#define WIFI_CONNECT_ATTEMPTS  20  // Round length: attempts x delay (10s)
+#define WIFI_CONNECT_DELAY_MS 500
 #define WIFI_CONNECT_RETRIES    3  // Number of full rounds before giving up
-#define WIFI_FAIL_RESTART_MS 2000  // Delay before reboot on connection failure (ms)
+#define WIFI_ROUND_PAUSE_MS  1000  // Disconnected pause between rounds
+#define WIFI_FAIL_RESTART_MS 2000  // Delay before setup mode on connection failure (ms)
+
+// Fast reconnect: the cached access point (BSSID + channel) is tried first,
+// without a channel scan. Falls back to the full path on failure.
+// WIFI_REUSE_IP applies the cached IP configuration too (no DHCP round trip).
+// The lease is never renewed: only enable it with a DHCP reservation for
+// the device, or its address can be handed to another host.
+#define WIFI_FAST_CONNECT_TIMEOUT_MS  3000
+#define WIFI_REUSE_IP                 0
+
+// Provisioning portal network scan (runs in the background, see wifi_manager.h)
+#define WIFI_SCAN_MAX         16     // Networks kept (strongest first)
+#define WIFI_SCAN_MAX_AGE_MS  10000  // GET /scan starts a new scan when the list is older
 
 // Backlight brightness (0-255, PWM on pin 22)
 #define BACKLIGHT_NORMAL  255
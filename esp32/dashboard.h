@@ -0,0 +1,287 @@
+/*
+ * VibeMon Dashboard
+ * Multi-project view: one tile per recently active project, each with a
+ * cached mini character sprite, state color and memory bar
+ */
+
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+// Forward declaration (defined in rotation.h)
+void setRotationActive(bool active);
+
+#if DASHBOARD_TILES < 1 || SCREEN_HEIGHT / DASHBOARD_TILES < DASHBOARD_MINI_SIZE + 8
+#error "DASHBOARD_TILES too large for the mini sprite"
+#endif
+
+// =============================================================================
+// Tile Layout
+// =============================================================================
+
+#define DASH_TILE_H    (SCREEN_HEIGHT / DASHBOARD_TILES)
+#define DASH_MINI_X    4
+#define DASH_TEXT_X    (DASH_MINI_X + DASHBOARD_MINI_SIZE + 6)
+#define DASH_TEXT_W    (SCREEN_WIDTH - DASH_TEXT_X - 4)
+#define DASH_BAR_H     6
+
+// What a tile currently shows. A tile is redrawn only when this changes.
+struct DashboardTile {
+  ProjectId projectId;       // PROJECT_NONE = empty tile
+  uint32_t nameHash;         // Detects an ID reused after eviction
+  int8_t state;
+  int8_t memory;
+  char tool[32];
+  const CharacterGeometry* character;
+  bool drawn;
+
+  // Cached mini character: rebuilt only when state or character changes
+  TFT_eSprite mini;
+  bool miniReady;            // Sprite buffer allocated
+  int8_t miniState;          // State the cached image was drawn for (-1 = none)
+  const CharacterGeometry* miniCharacter;
+};
+
+DashboardTile dashboardTiles[DASHBOARD_TILES];
+bool dashboardNeedsClear = true;
+
+// =============================================================================
+// Tile Assignment
+// =============================================================================
+
+// State shown for a project: its last state after the timeouts it would
+// have gone through on screen (see checkSleepTimer())
+AppState getDashboardState(const ProjectSnapshot& snapshot) {
+  if (snapshot.state < 0) return STATE_IDLE;
+  unsigned long since = snapshot.updatedAt;
+  return applyStateTimeouts((AppState)snapshot.state, since, millis());
+}
+
+bool isProjectOnDashboard(ProjectId id) {
+  for (int i = 0; i < DASHBOARD_TILES; i++) {
+    if (dashboardTiles[i].projectId == id) return true;
+  }
+  return false;
+}
+
+// Keep tiles stable: a project stays in its tile while it is among the
+// DASHBOARD_TILES most recently active; newcomers take tiles that fell out
+void assignDashboardTiles() {
+  ProjectId shown[DASHBOARD_TILES];
+  int shownCount = 0;
+  for (ProjectId id = projectLruHead; id != PROJECT_NONE && shownCount < DASHBOARD_TILES;
+       id = projectTable[id].lruNext) {
+    shown[shownCount++] = id;
+  }
+
+  // Release tiles whose project dropped out (or whose ID was reused)
+  for (int i = 0; i < DASHBOARD_TILES; i++) {
+    DashboardTile& tile = dashboardTiles[i];
+    if (tile.projectId == PROJECT_NONE) continue;
+    bool keep = tile.projectId < projectCount && projectTable[tile.projectId].hash == tile.nameHash;
+    if (keep) {
+      keep = false;
+      for (int j = 0; j < shownCount; j++) {
+        if (shown[j] == tile.projectId) keep = true;
+      }
+    }
+    if (!keep) {
+      tile.projectId = PROJECT_NONE;
+      tile.drawn = false;
+    }
+  }
+
+  // Place newcomers in free tiles (top first)
+  for (int j = 0; j < shownCount; j++) {
+    if (isProjectOnDashboard(shown[j])) continue;
+    for (int i = 0; i < DASHBOARD_TILES; i++) {
+      DashboardTile& tile = dashboardTiles[i];
+      if (tile.projectId != PROJECT_NONE) continue;
+      tile.projectId = shown[j];
+      tile.nameHash = projectTable[shown[j]].hash;
+      tile.drawn = false;
+      break;
+    }
+  }
+}
+
+// =============================================================================
+// Tile Rendering
+// =============================================================================
+
+// Rebuild the cached mini character: compose the full 128x128 character in
+// charSprite, then scale it down into the tile's sprite
+void updateDashboardMini(DashboardTile& tile, AppState state) {
+  if (tile.miniState == state && tile.miniCharacter == tile.character) return;
+  uint16_t bgColor = getBackgroundColorEnum(state);
+  drawCharacterToSprite(charSprite, getEyeTypeEnum(state), getEffectTypeEnum(state), bgColor, tile.character);
+  tile.mini.fillSprite(bgColor);
+  float zoom = (float)DASHBOARD_MINI_SIZE / CHAR_WIDTH;
+  charSprite.pushRotateZoomWithAA(&tile.mini, DASHBOARD_MINI_SIZE / 2, DASHBOARD_MINI_SIZE / 2, 0, zoom, zoom);
+  tile.miniState = state;
+  tile.miniCharacter = tile.character;
+}
+
+void drawDashboardTile(int index) {
+  DashboardTile& tile = dashboardTiles[index];
+  int y = index * DASH_TILE_H;
+
+  if (tile.projectId == PROJECT_NONE) {
+    tft.fillRect(0, y, SCREEN_WIDTH, DASH_TILE_H, TFT_BLACK);
+    if (index == 0 && projectCount == 0) {
+      tft.setTextColor(COLOR_TEXT_DIM);
+      tft.setTextSize(1);
+      tft.setCursor((SCREEN_WIDTH - 10 * 6) / 2, y + DASH_TILE_H / 2 - 4);
+      tft.println("Waiting...");
+    }
+    return;
+  }
+
+  AppState state = (AppState)tile.state;
+  uint16_t bgColor = getBackgroundColorEnum(state);
+  uint16_t textColor = getTextColorEnum(state);
+  tft.fillRect(0, y, SCREEN_WIDTH, DASH_TILE_H - 1, bgColor);
+  tft.fillRect(0, y + DASH_TILE_H - 1, SCREEN_WIDTH, 1, TFT_BLACK);  // Separator
+
+  // Mini character (vertically centered)
+  int miniY = y + (DASH_TILE_H - 1 - DASHBOARD_MINI_SIZE) / 2;
+  if (tile.miniReady && spriteInitialized) {
+    updateDashboardMini(tile, state);
+    tile.mini.pushSprite(DASH_MINI_X, miniY);
+  }
+
+  // Project name (size 1)
+  char name[24];
+  truncateText(getProjectName(tile.projectId), name, sizeof(name), DASH_TEXT_W / 6, DASH_TEXT_W / 6 - 3);
+  tft.setTextColor(textColor);
+  tft.setTextSize(1);
+  tft.setCursor(DASH_TEXT_X, y + 5);
+  tft.print(name);
+
+  // Status text (size 2)
+  char statusText[32];
+  if (state == STATE_WORKING) {
+    getWorkingText(tile.tool, statusText, sizeof(statusText));
+  } else {
+    getStatusTextEnum(state, statusText, sizeof(statusText));
+  }
+  tft.setTextSize(2);
+  tft.setCursor(DASH_TEXT_X, y + 17);
+  tft.print(statusText);
+
+  // Memory bar
+  if (tile.memory > 0) {
+    drawMemoryBar(tft, DASH_TEXT_X, y + DASH_TILE_H - DASH_BAR_H - 6, DASH_TEXT_W, DASH_BAR_H, tile.memory, bgColor);
+  }
+}
+
+// =============================================================================
+// Dashboard Drawing
+// =============================================================================
+
+// Allocate mini sprites on entry and free them on exit (~2KB each)
+void setDashboardActive(bool active) {
+  for (int i = 0; i < DASHBOARD_TILES; i++) {
+    DashboardTile& tile = dashboardTiles[i];
+    if (active && !tile.miniReady) {
+      tile.mini.setColorDepth(16);
+      tile.miniReady = (tile.mini.createSprite(DASHBOARD_MINI_SIZE, DASHBOARD_MINI_SIZE) != nullptr);
+    } else if (!active && tile.miniReady) {
+      tile.mini.deleteSprite();
+      tile.miniReady = false;
+    }
+    tile.projectId = PROJECT_NONE;
+    tile.drawn = false;
+    tile.miniState = -1;
+  }
+  dashboardNeedsClear = true;
+}
+
+// Called from loop() in dashboard mode: redraws only tiles whose project,
+// state, tool, memory or character changed
+void drawDashboard() {
+  if (dashboardNeedsClear) {
+    tft.setBrightness(BACKLIGHT_NORMAL);
+    tft.fillScreen(TFT_BLACK);
+    for (int i = 0; i < DASHBOARD_TILES; i++) {
+      dashboardTiles[i].drawn = false;
+    }
+    dashboardNeedsClear = false;
+  }
+
+  assignDashboardTiles();
+
+  for (int i = 0; i < DASHBOARD_TILES; i++) {
+    DashboardTile& tile = dashboardTiles[i];
+    if (tile.projectId == PROJECT_NONE) {
+      if (!tile.drawn) {
+        drawDashboardTile(i);
+        tile.drawn = true;
+      }
+      continue;
+    }
+
+    const ProjectSnapshot& snapshot = projectTable[tile.projectId].snapshot;
+    AppState state = getDashboardState(snapshot);
+    const char* tool = state == STATE_WORKING ? snapshot.tool : "";
+    const CharacterGeometry* character = getCharacterByName(
+      strlen(snapshot.character) > 0 ? snapshot.character : currentCharacter);
+
+    if (tile.drawn && tile.state == state && tile.memory == snapshot.memory &&
+        tile.character == character && strcmp(tile.tool, tool) == 0) {
+      continue;
+    }
+
+    tile.state = state;
+    tile.memory = snapshot.memory;
+    tile.character = character;
+    safeCopyStr(tile.tool, tool);
+    drawDashboardTile(i);
+    tile.drawn = true;
+  }
+}
+
+// =============================================================================
+// View Mode
+// =============================================================================
+
+const char* getViewModeString() {
+  if (viewMode == VIEW_MODE_DASHBOARD) return "dashboard";
+  if (viewMode == VIEW_MODE_ROTATION) return "rotation";
+  return "single";
+}
+
+int parseViewMode(const char* modeStr) {
+  if (strcmp(modeStr, "single") == 0) return VIEW_MODE_SINGLE;
+  if (strcmp(modeStr, "dashboard") == 0) return VIEW_MODE_DASHBOARD;
+  if (strcmp(modeStr, "rotation") == 0) return VIEW_MODE_ROTATION;
+  return -1;  // Invalid mode
+}
+
+// Switch view mode (persisted). Rendering happens in loop().
+void setViewMode(int mode) {
+  if (mode != VIEW_MODE_SINGLE && mode != VIEW_MODE_DASHBOARD && mode != VIEW_MODE_ROTATION) return;
+  if (mode != viewMode) {
+    if (viewMode == VIEW_MODE_ROTATION) {
+      lockedProjectId = PROJECT_NONE;  // Release the rotation's lock: lock mode takes over
+    }
+    viewMode = mode;
+    setDashboardActive(mode == VIEW_MODE_DASHBOARD);
+    setRotationActive(mode == VIEW_MODE_ROTATION);
+    if (mode != VIEW_MODE_DASHBOARD) {
+      // Full redraw of the single-project screen
+      needsRedraw = true;
+      dirtyCharacter = true;
+      dirtyStatus = true;
+      dirtyInfo = true;
+    }
+
+    settings.viewMode = viewMode;
+    markSettingsDirty();
+  }
+
+  commandReply->print("{\"view\":\"");
+  commandReply->print(getViewModeString());
+  commandReply->println("\"}");
+}
+
+#endif // DASHBOARD_H
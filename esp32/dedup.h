@@ -0,0 +1,101 @@
+/*
+ * VibeMon Input De-duplication
+ * Suppresses the same status event arriving over several transports
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+// =============================================================================
+// Recent Event Window
+// =============================================================================
+
+// Hook scripts post to the device over HTTP while the cloud relay pushes the
+// same event over WebSocket. Each status update is reduced to a 32-bit key
+// (client eventId if present, otherwise a hash of the status fields) and
+// checked against a small ring of recently applied keys.
+struct DedupEntry {
+  uint32_t key;
+  unsigned long seenAt;
+  uint8_t source;       // InputSource that delivered the first copy
+  bool hasEventId;      // Key derived from client-supplied eventId
+};
+
+DedupEntry dedupWindow[DEDUP_WINDOW_SIZE];
+uint8_t dedupCount = 0;
+uint8_t dedupNext = 0;
+
+// Suppressed duplicate counters (per transport that delivered the extra copy)
+uint32_t dedupSuppressed[INPUT_SOURCE_COUNT] = {0};
+
+// =============================================================================
+// Key Computation
+// =============================================================================
+
+// Build dedup key for a status object. Sets hasEventId when the client
+// supplied "eventId" (string or integer).
+uint32_t computeDedupKey(JsonObject doc, bool& hasEventId) {
+  const char* eventId = doc["eventId"] | "";
+  if (strlen(eventId) > 0) {
+    hasEventId = true;
+    return fnv1a(eventId, fnv1a("id"));
+  }
+  long numericId = doc["eventId"] | -1L;
+  if (numericId >= 0) {
+    char idBuf[21];  // Any 64-bit long
+    snprintf(idBuf, sizeof(idBuf), "%ld", numericId);
+    hasEventId = true;
+    return fnv1a(idBuf, fnv1a("id"));
+  }
+
+  hasEventId = false;
+  char memBuf[12];  // Any int
+  snprintf(memBuf, sizeof(memBuf), "%d", (int)(doc["memory"] | -1));
+  uint32_t hash = fnv1a(doc["state"] | "");
+  hash = fnv1a(doc["project"] | "", hash);
+  hash = fnv1a(doc["tool"] | "", hash);
+  hash = fnv1a(doc["model"] | "", hash);
+  hash = fnv1a(memBuf, hash);
+  hash = fnv1a(doc["character"] | "", hash);
+  return hash;
+}
+
+// =============================================================================
+// Duplicate Check
+// =============================================================================
+
+// Returns true if this status update is a duplicate that must not be applied.
+// Otherwise the key is remembered and false is returned.
+//
+// eventId matches are duplicates regardless of transport. Content-hash matches
+// only count when the earlier copy came from a different transport: the same
+// source legitimately repeats a payload (e.g. working -> done -> working).
+bool isDuplicateStatus(JsonObject doc, InputSource source) {
+  bool hasEventId = false;
+  uint32_t key = computeDedupKey(doc, hasEventId);
+  unsigned long now = millis();
+
+  for (uint8_t i = 0; i < dedupCount; i++) {
+    DedupEntry& entry = dedupWindow[i];
+    if (entry.key != key || entry.hasEventId != hasEventId) continue;
+    if (now - entry.seenAt > DEDUP_HORIZON_MS) continue;
+    if (hasEventId || entry.source != source) {
+      dedupSuppressed[source]++;
+      return true;
+    }
+    // Same transport repeating itself: refresh and treat as new event
+    entry.seenAt = now;
+    return false;
+  }
+
+  DedupEntry& slot = dedupWindow[dedupNext];
+  slot.key = key;
+  slot.seenAt = now;
+  slot.source = (uint8_t)source;
+  slot.hasEventId = hasEventId;
+  dedupNext = (dedupNext + 1) % DEDUP_WINDOW_SIZE;
+  if (dedupCount < DEDUP_WINDOW_SIZE) dedupCount++;
+  return false;
+}
+
+#endif // DEDUP_H
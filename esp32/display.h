@@ -113,18 +113,70 @@ void truncateText(const char* src, char* dst, size_t dstSize, int maxLen, int tr
   }
 }
 
-// Helper: Draw icon + truncated text as a single info row
+// Helper: Draw icon + truncated text as a single info row (TFT or sprite)
 // FreeSans9pt7b ~14px height; icon scale=1 (10px), centered at y+2; text at x=24
-void drawInfoRow(int y, void (*iconFn)(TFT_eSPI&, int, int, uint16_t, int, uint16_t), const char* text, uint16_t textColor, uint16_t bgColor) {
-  tft.setTextColor(textColor);
-  tft.setFont(&fonts::FreeSans9pt7b);
-  tft.setTextSize(1);
-  iconFn(tft, 10, y + 2, textColor, 1, bgColor);
-  tft.setCursor(24, y);
+template<typename T>
+void drawInfoRow(T &canvas, int y, void (*iconFn)(T&, int, int, uint16_t, int, uint16_t), const char* text, uint16_t textColor, uint16_t bgColor) {
+  canvas.setTextColor(textColor);
+  canvas.setFont(&fonts::FreeSans9pt7b);
+  canvas.setTextSize(1);
+  iconFn(canvas, 10, y + 2, textColor, 1, bgColor);
+  canvas.setCursor(24, y);
   char display[20];
   truncateText(text, display, sizeof(display), 15, 12);
-  tft.print(display);
-  tft.setFont(nullptr);
+  canvas.print(display);
+  canvas.setFont(nullptr);
+}
+
+// Helper: Draw status text (centered, size 3) for a state (TFT or sprite)
+template<typename T>
+void drawStatusText(T &canvas, AppState state, const char* tool, uint16_t textColor) {
+  char statusText[32];
+  if (state == STATE_WORKING) {
+    getWorkingText(tool, statusText, sizeof(statusText));
+  } else {
+    getStatusTextEnum(state, statusText, sizeof(statusText));
+  }
+
+  canvas.setTextColor(textColor);
+  canvas.setTextSize(3);
+  int textX = (SCREEN_WIDTH - canvas.textWidth(statusText)) / 2;
+  canvas.setCursor(textX, STATUS_TEXT_Y);
+  canvas.println(statusText);
+}
+
+// Helper: Draw project, tool, model, memory info rows (TFT or sprite)
+template<typename T>
+void drawInfoRows(T &canvas, AppState state, const char* project, const char* tool, const char* model,
+                  int memory, uint16_t textColor, uint16_t bgColor) {
+  if (strlen(project) > 0) {
+    drawInfoRow(canvas, PROJECT_Y, drawFolderIcon<T>, project, textColor, bgColor);
+  }
+
+  // Tool name (working state only)
+  if (strlen(tool) > 0 && state == STATE_WORKING) {
+    drawInfoRow(canvas, TOOL_Y, drawToolIcon<T>, tool, textColor, bgColor);
+  }
+
+  // Model name
+  if (strlen(model) > 0) {
+    drawInfoRow(canvas, MODEL_Y, drawRobotIcon<T>, model, textColor, bgColor);
+  }
+
+  // Memory usage (hide on start state)
+  if (memory > 0 && state != STATE_START) {
+    canvas.setTextColor(textColor);
+    canvas.setFont(&fonts::FreeSans9pt7b);
+    canvas.setTextSize(1);
+    drawBrainIcon(canvas, 10, MEMORY_Y + 2, textColor, 1, bgColor);
+    canvas.setCursor(24, MEMORY_Y);
+    canvas.print(memory);
+    canvas.print("%");
+    canvas.setFont(nullptr);
+
+    // Memory bar (below percentage)
+    drawMemoryBar(canvas, MEMORY_BAR_X, MEMORY_BAR_Y, MEMORY_BAR_W, MEMORY_BAR_H, memory, bgColor);
+  }
 }
 
 // =============================================================================
@@ -140,7 +192,9 @@ void drawCharacterSection(uint16_t bgColor, EyeType eyeType, EffectType effectTy
 
   if (spriteInitialized) {
     drawCharacterToSprite(charSprite, eyeType, effectType, bgColor, character);
+    TRACE_BEGIN(TRACE_PUSH_SPRITE, TRACE_PUSH_CHARACTER);
     charSprite.pushSprite(charX, charY);
+    TRACE_END(TRACE_PUSH_SPRITE, TRACE_PUSH_CHARACTER);
   } else {
     drawCharacter(tft, charX, charY, eyeType, effectType, bgColor, character);
   }
@@ -153,18 +207,7 @@ void drawStatusTextSection(uint16_t bgColor, uint16_t textColor) {
     tft.fillRect(0, STATUS_TEXT_Y, SCREEN_WIDTH, LOADING_Y - STATUS_TEXT_Y, bgColor);
   }
 
-  char statusText[32];
-  if (currentState == STATE_WORKING) {
-    getWorkingText(currentTool, statusText, sizeof(statusText));
-  } else {
-    getStatusTextEnum(currentState, statusText, sizeof(statusText));
-  }
-
-  tft.setTextColor(textColor);
-  tft.setTextSize(3);
-  int textX = (SCREEN_WIDTH - tft.textWidth(statusText)) / 2;
-  tft.setCursor(textX, STATUS_TEXT_Y);
-  tft.println(statusText);
+  drawStatusText(tft, currentState, currentTool, textColor);
 }
 
 // Draw project, tool, model, memory info rows
@@ -174,37 +217,11 @@ void drawInfoSection(uint16_t bgColor, uint16_t textColor) {
     tft.fillRect(0, PROJECT_Y, SCREEN_WIDTH, SCREEN_HEIGHT - PROJECT_Y, bgColor);
   }
 
-  if (strlen(currentProject) > 0) {
-    drawInfoRow(PROJECT_Y, drawFolderIcon, currentProject, textColor, bgColor);
-  }
-
-  // Tool name (working state only)
-  if (strlen(currentTool) > 0 && currentState == STATE_WORKING) {
-    drawInfoRow(TOOL_Y, drawToolIcon, currentTool, textColor, bgColor);
-  }
-
-  // Model name
-  if (strlen(currentModel) > 0) {
-    drawInfoRow(MODEL_Y, drawRobotIcon, currentModel, textColor, bgColor);
-  }
-
-  // Memory usage (hide on start state)
-  if (currentMemory > 0 && currentState != STATE_START) {
-    tft.setTextColor(textColor);
-    tft.setFont(&fonts::FreeSans9pt7b);
-    tft.setTextSize(1);
-    drawBrainIcon(tft, 10, MEMORY_Y + 2, textColor, 1, bgColor);
-    tft.setCursor(24, MEMORY_Y);
-    tft.print(currentMemory);
-    tft.print("%");
-    tft.setFont(nullptr);
-
-    // Memory bar (below percentage)
-    drawMemoryBar(tft, MEMORY_BAR_X, MEMORY_BAR_Y, MEMORY_BAR_W, MEMORY_BAR_H, currentMemory, bgColor);
-  }
+  drawInfoRows(tft, currentState, currentProject, currentTool, currentModel, currentMemory, textColor, bgColor);
 }
 
 void drawStatus() {
+  TRACE_SCOPE(TRACE_DRAW_STATUS, 0);
   uint16_t bgColor = getBackgroundColorEnum(currentState);
   uint16_t textColor = getTextColorEnum(currentState);
   EyeType eyeType = getEyeTypeEnum(currentState);
@@ -305,7 +322,9 @@ void updateAnimation() {
       }
       // Draw to sprite and push to screen in one operation
       drawCharacterToSprite(charSprite, eyeType, effectType, bgColor, character);
+      TRACE_BEGIN(TRACE_PUSH_SPRITE, TRACE_PUSH_CHARACTER);
       charSprite.pushSprite(newCharX, newCharY);
+      TRACE_END(TRACE_PUSH_SPRITE, TRACE_PUSH_CHARACTER);
     } else {
       // Fallback to direct drawing
       if (positionChanged) {
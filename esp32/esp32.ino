@@ -15,8 +15,9 @@
 #include <ArduinoJson.h>
 #include <Preferences.h>
 
-// WiFi configuration (create credentials.h from credentials.h.example)
-#if __has_include("credentials.h")
+// WiFi configuration (create credentials.h from credentials.h.example).
+// Not in the host build: the simulator runs setup()/loop() without WiFi.
+#if __has_include("credentials.h") && !defined(VIBEMON_HOST)
 #include "credentials.h"
 #endif
 
@@ -30,6 +31,16 @@
 #ifdef USE_WEBSOCKET
 #include <WebSocketsClient.h>
 #endif
+
+// UDP status ingest (optional, requires USE_WIFI)
+#ifdef USE_UDP
+#include <WiFiUdp.h>
+#endif
+
+// LAN WebSocket server (optional, requires USE_WIFI)
+#ifdef USE_WS_SERVER
+#include <WebSocketsServer.h>
+#endif
 #endif
 
 // =============================================================================
@@ -37,15 +48,31 @@
 // =============================================================================
 
 #include "config.h"
+#include "trace.h"
+#include "json_writer.h"
 #include "sprites.h"
 #include "ui_elements.h"
 #include "state.h"
+#include "settings.h"
 #include "display.h"
 #include "project_lock.h"
+#include "dashboard.h"
+#include "rotation.h"
+#include "session.h"
+#include "history.h"
+#include "dedup.h"
+#include "rate_limit.h"
+#include "latency.h"
+#include "ws_health.h"
+#include "status_queue.h"
 #include "input.h"
 
 #ifdef USE_WIFI
 #include "wifi_portal.h"
+#include "status_watch.h"
+#include "http_server.h"
+#include "udp_status.h"
+#include "ws_server.h"
 #include "wifi_manager.h"
 #endif
 
@@ -59,18 +86,13 @@ void setup() {
   // Reduce CPU frequency to 80MHz (sufficient for animation/WiFi, reduces heat)
   setCpuFrequencyMhz(80);
 
-  // Load settings from persistent storage
-  preferences.begin("vibemon", true);  // Read-only mode
-  lockMode = preferences.getInt("lockMode", LOCK_MODE_ON_THINKING);
-  preferences.end();
-
-  // Validate loaded lockMode (flash corruption safety)
-  if (lockMode != LOCK_MODE_FIRST_PROJECT && lockMode != LOCK_MODE_ON_THINKING) {
-    lockMode = LOCK_MODE_ON_THINKING;
-    preferences.begin("vibemon", false);
-    preferences.putInt("lockMode", lockMode);
-    preferences.end();
-  }
+  // Empty project table (hash index starts with no entries)
+  resetProjectTable();
+
+  // Load settings from persistent storage (validated, cached in RAM)
+  loadSettings();
+  lockMode = settings.lockMode;
+  int savedViewMode = settings.viewMode;  // Applied after sprite init
 
   // TFT init
   tft.init();
@@ -89,17 +111,32 @@ void setup() {
     Serial.println("{\"sprite\":\"failed\",\"error\":\"memory\"}");
   }
 
-  // Start screen
-  drawStartScreen();
+  // Restore the session from before the last restart (lock, projects, screen)
+  bool sessionRestored = restoreSession();
 
-  // Initialize sleep timer
-  lastActivityTime = millis();
+  // Restore view mode (dashboard and rotation compose via the character sprite)
+  if (savedViewMode == VIEW_MODE_DASHBOARD) {
+    viewMode = VIEW_MODE_DASHBOARD;
+    setDashboardActive(true);
+  } else if (savedViewMode == VIEW_MODE_ROTATION) {
+    viewMode = VIEW_MODE_ROTATION;
+    setRotationActive(true);
+  }
+
+  // First frame before WiFi: the restored screen, or the start screen
+  if (!sessionRestored) {
+    drawStartScreen();
+    lastActivityTime = millis();  // Initialize sleep timer
+  } else if (viewMode == VIEW_MODE_DASHBOARD) {
+    drawDashboard();
+  } else {
+    drawStatus();
+  }
 
 #ifdef USE_WIFI
-  setupWiFi();
-#ifdef USE_WEBSOCKET
-  setupWebSocket();
-#endif
+  // Starts connecting and returns: loop() completes the bring-up (and starts
+  // the WebSocket), so Serial input and rendering work meanwhile
+  setupWiFi(!sessionRestored);
 #endif
 }
 
@@ -109,6 +146,7 @@ void loop() {
   // USB Serial check (using char buffer instead of String)
   while (Serial.available()) {
     char c = Serial.read();
+    if (serialBufferPos == 0 && c != '\n') TRACE_INSTANT(TRACE_INPUT, INPUT_SERIAL);
     if (c == '\n') {
       if (serialOverflow) {
         Serial.println("{\"error\":\"input too long\"}");
@@ -116,7 +154,9 @@ void loop() {
       } else {
         serialBuffer[serialBufferPos] = '\0';
         if (serialBufferPos > 0) {
-          processInput(serialBuffer);
+          if (processInput(serialBuffer, INPUT_SERIAL, 0) == INPUT_THROTTLED) {
+            Serial.println("{\"throttled\":true}");
+          }
         }
       }
       serialBufferPos = 0;
@@ -130,35 +170,77 @@ void loop() {
 #ifdef USE_WIFI
   if (provisioningMode) {
     dnsServer.processNextRequest();
+    server.handleClient();  // Setup portal
+    pollWiFiScan();
+  } else if (isWiFiReady()) {
+    pollHttpServer();  // Status API
+#ifdef USE_UDP
+    pollUdpStatus();
+#endif
+#ifdef USE_WS_SERVER
+    pollWsServer();
+#endif
   }
-  checkWiFiConnection();
-  server.handleClient();
+  updateWiFiConnection();  // Bring-up steps, then drop/recovery checks
 #ifdef USE_WEBSOCKET
   webSocket.loop();
+  updateWsHeartbeat();
 #endif
 #endif
 
   // === STATE MANAGEMENT ===
 
+  // Apply queued status updates (coalesced since last iteration)
+  drainStatusQueue();
+
   // Check sleep timer (may set dirty flags via transitionToState)
   checkSleepTimer();
 
+  // Persistence: settings changes and session snapshot (debounced NVS writes)
+  updateSettings();
+  updateSession();
+
   // === RENDERING ===
 
-  // Full screen redraw if state/info changed (centralized rendering)
-  if (needsRedraw || dirtyCharacter || dirtyStatus || dirtyInfo) {
-    drawStatus();
-  }
+  if (viewMode == VIEW_MODE_DASHBOARD) {
+    // Dashboard: redraws only tiles whose project changed (no animation)
+    drawDashboard();
+  } else {
+    // Rotation: switches project at the end of each dwell (pushes the
+    // pre-composed screen and clears the dirty flags when it can)
+    if (viewMode == VIEW_MODE_ROTATION) {
+      updateRotation();
+    }
+
+    // Full screen redraw if state/info changed (centralized rendering)
+    if (needsRedraw || dirtyCharacter || dirtyStatus || dirtyInfo) {
+      drawStatus();
+    }
 
-  // Animation update (100ms interval)
-  if (millis() - lastUpdate > 100) {
-    lastUpdate = millis();
-    animFrame = (animFrame + 1) % ANIM_FRAME_WRAP;
-    updateAnimation();
+    // Animation update (100ms interval)
+    if (millis() - lastUpdate > 100) {
+      lastUpdate = millis();
+      animFrame = (animFrame + 1) % ANIM_FRAME_WRAP;
+      updateAnimation();
+    }
+
+    // Idle blink (non-blocking state machine)
+    updateBlink();
   }
 
-  // Idle blink (non-blocking state machine)
-  updateBlink();
+  // Latency probes whose update is now on the panel
+  completeProbeFlushes();
+
+#ifdef USE_WIFI
+  // Status watchers: long polls, event streams and LAN WebSocket
+  // subscribers learn about changes after the panel shows them
+  if (isWiFiReady()) {
+    serviceHttpWatchers();
+#ifdef USE_WS_SERVER
+    pushWsServerUpdates();
+#endif
+  }
+#endif
 
   // Yield to FreeRTOS: state-based delay reduces CPU usage and heat.
   // Active states: 10ms, idle/done: 30ms, sleep: 100ms.
@@ -0,0 +1,241 @@
+/*
+ * VibeMon History
+ * Ring log of compact state transition records, with per-project
+ * aggregates (time in state, tool counts, memory peak) kept incrementally
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#if HISTORY_TOOLS < 2 || HISTORY_TOOLS > 255
+#error "HISTORY_TOOLS must be 2-255 (tool IDs are uint8_t, last ID is \"other\")"
+#endif
+
+// =============================================================================
+// History Records
+// =============================================================================
+
+#define HISTORY_STATES    (STATE_ALERT + 1)
+#define HISTORY_TOOL_NONE 0xFF
+
+// One transition (8 bytes)
+struct HistoryRecord {
+  uint32_t deltaMs;   // Since the previous record
+  ProjectId project;  // PROJECT_NONE: screen without a project
+  uint8_t state;      // AppState
+  uint8_t tool;       // Index into historyTools[], HISTORY_TOOL_NONE
+  int8_t memory;      // 0-100, or -1 if not received
+};
+
+HistoryRecord historyRing[HISTORY_RECORDS];
+uint16_t historyNext = 0;         // Slot for the next record
+uint16_t historyCount = 0;        // Records in the ring
+uint32_t historyTotal = 0;        // Records ever written (sequence of the next one)
+unsigned long historyLastAt = 0;  // millis() of the newest record
+
+// Tool names, interned on first use (the last ID collects the rest)
+char historyTools[HISTORY_TOOLS][16];
+uint8_t historyToolCount = 0;
+
+// Per-project aggregates, indexed by ProjectId
+struct HistoryProject {
+  uint32_t hash;        // Detects an ID reused after eviction
+  uint32_t firstSeq;    // Older ring records belong to a previous owner of the ID
+  int8_t state;         // Current state (-1 = none yet)
+  int8_t memoryPeak;
+  uint16_t transitions;
+  unsigned long since;  // When the current state was entered (or last accrued)
+  uint32_t stateMs[HISTORY_STATES];
+  uint16_t toolCounts[HISTORY_TOOLS];
+};
+
+HistoryProject historyProjects[MAX_PROJECTS];
+
+// Intern a tool name (HISTORY_TOOL_NONE for "")
+uint8_t getHistoryToolId(const char* tool) {
+  if (strlen(tool) == 0) return HISTORY_TOOL_NONE;
+  for (uint8_t i = 0; i < historyToolCount; i++) {
+    if (strncmp(historyTools[i], tool, sizeof(historyTools[i]) - 1) == 0) return i;
+  }
+  if (historyToolCount == HISTORY_TOOLS - 1) return HISTORY_TOOLS - 1;
+  safeCopyStr(historyTools[historyToolCount], tool);
+  return historyToolCount++;
+}
+
+const char* getHistoryToolName(uint8_t tool) {
+  if (tool == HISTORY_TOOL_NONE) return "";
+  return tool < historyToolCount ? historyTools[tool] : "other";
+}
+
+// =============================================================================
+// Aggregates
+// =============================================================================
+
+// Aggregates for a project, cleared when its ID belongs to a new project
+HistoryProject& getHistoryProject(ProjectId id) {
+  HistoryProject& project = historyProjects[id];
+  if (project.hash != projectTable[id].hash) {
+    memset(&project, 0, sizeof(project));
+    project.hash = projectTable[id].hash;
+    project.firstSeq = historyTotal;
+    project.state = -1;
+    project.memoryPeak = -1;
+  }
+  return project;
+}
+
+// Add the time since `since` to the state it was spent in, splitting it at
+// the timeouts the screen would apply (see applyStateTimeouts())
+void accrueHistoryTime(HistoryProject& project, unsigned long now) {
+  if (project.state < 0) {
+    project.since = now;
+    return;
+  }
+  AppState state = (AppState)project.state;
+  if ((state == STATE_START || state == STATE_DONE) && now - project.since >= IDLE_TIMEOUT) {
+    project.stateMs[state] += IDLE_TIMEOUT;
+    project.since += IDLE_TIMEOUT;
+    state = STATE_IDLE;
+  } else if (isActiveState(state) && now - project.since >= SLEEP_TIMEOUT) {
+    project.stateMs[state] += SLEEP_TIMEOUT;
+    project.since += SLEEP_TIMEOUT;
+    state = STATE_IDLE;
+  }
+  if (state == STATE_IDLE && now - project.since >= SLEEP_TIMEOUT) {
+    project.stateMs[state] += SLEEP_TIMEOUT;
+    project.since += SLEEP_TIMEOUT;
+    state = STATE_SLEEP;
+  }
+  project.stateMs[state] += now - project.since;
+  project.since = now;
+  project.state = state;
+}
+
+// =============================================================================
+// Recording
+// =============================================================================
+
+void appendHistoryRecord(ProjectId id, AppState state, uint8_t tool, int8_t memory, unsigned long now) {
+  HistoryRecord& record = historyRing[historyNext];
+  record.deltaMs = historyTotal > 0 ? now - historyLastAt : now;
+  record.project = id;
+  record.state = state;
+  record.tool = tool;
+  record.memory = memory;
+  historyNext = (historyNext + 1) % HISTORY_RECORDS;
+  if (historyCount < HISTORY_RECORDS) historyCount++;
+  historyTotal++;
+  historyLastAt = now;
+}
+
+// Record a status update admitted for a project (called from
+// admitStatusUpdate() with the snapshot before the update was merged).
+// Only state and tool changes are logged; memory only feeds the peak.
+void recordProjectHistory(ProjectId id, const ProjectSnapshot& before, const ProjectSnapshot& after) {
+  unsigned long now = millis();
+  HistoryProject& project = getHistoryProject(id);
+  if (after.memory > project.memoryPeak) project.memoryPeak = after.memory;
+  if (after.state < 0) return;
+  if (after.state == before.state && strcmp(after.tool, before.tool) == 0) return;
+
+  uint8_t tool = after.state == STATE_WORKING ? getHistoryToolId(after.tool) : HISTORY_TOOL_NONE;
+  accrueHistoryTime(project, now);
+  project.state = after.state;
+  project.transitions++;
+  if (tool != HISTORY_TOOL_NONE) project.toolCounts[tool]++;
+  appendHistoryRecord(id, (AppState)after.state, tool, after.memory, now);
+}
+
+// Record a timeout transition of the single-project screen (called from
+// transitionToState()). Aggregates already account for timeouts.
+void recordScreenHistory(AppState state) {
+  ProjectId id = findProject(currentProject);
+  unsigned long now = millis();
+  if (id != PROJECT_NONE) {
+    HistoryProject& project = getHistoryProject(id);
+    accrueHistoryTime(project, now);
+    project.state = state;
+  }
+  appendHistoryRecord(id, state, HISTORY_TOOL_NONE, currentMemory, now);
+}
+
+// =============================================================================
+// Stats JSON (streamed)
+// =============================================================================
+
+// Write the stats JSON to `out` (anything with print(const char*)) piece by
+// piece: aggregates first, then the ring oldest first. No document is built.
+template <typename Out>
+void writeStatsJson(Out& out) {
+  char line[160];
+  unsigned long now = millis();
+
+  snprintf(line, sizeof(line), "{\"now\":%lu,\"total\":%lu,\"projects\":[",
+    now, (unsigned long)historyTotal);
+  out.print(line);
+
+  bool first = true;
+  for (ProjectId id = projectLruHead; id != PROJECT_NONE; id = projectTable[id].lruNext) {
+    if (historyProjects[id].hash != projectTable[id].hash) continue;
+    HistoryProject project = historyProjects[id];  // Accrue a copy up to now
+    accrueHistoryTime(project, now);
+
+    out.print(first ? "{\"project\":" : ",{\"project\":");
+    jsonPrintString(out, projectTable[id].name);
+    snprintf(line, sizeof(line), ",\"transitions\":%u,\"memoryPeak\":%d,\"stateMs\":{",
+      project.transitions, project.memoryPeak);
+    out.print(line);
+    first = false;
+
+    bool firstField = true;
+    for (int s = 0; s < HISTORY_STATES; s++) {
+      if (project.stateMs[s] == 0) continue;
+      snprintf(line, sizeof(line), "%s\"%s\":%lu", firstField ? "" : ",",
+        getStateString((AppState)s), (unsigned long)project.stateMs[s]);
+      out.print(line);
+      firstField = false;
+    }
+    out.print("},\"tools\":{");
+    firstField = true;
+    for (int t = 0; t < HISTORY_TOOLS; t++) {
+      if (project.toolCounts[t] == 0) continue;
+      if (!firstField) out.print(",");
+      jsonPrintString(out, getHistoryToolName(t));
+      snprintf(line, sizeof(line), ":%u", project.toolCounts[t]);
+      out.print(line);
+      firstField = false;
+    }
+    out.print("}}");
+  }
+
+  // Records as [t, project, state, tool, memory], t in millis(). Times are
+  // rebuilt backwards from the newest record.
+  out.print("],\"history\":[");
+  uint16_t oldest = (historyNext + HISTORY_RECORDS - historyCount) % HISTORY_RECORDS;
+  unsigned long t = historyLastAt;
+  for (uint16_t i = 1; i < historyCount; i++) {
+    t -= historyRing[(oldest + i) % HISTORY_RECORDS].deltaMs;
+  }
+  uint32_t seq = historyTotal - historyCount;
+  for (uint16_t i = 0; i < historyCount; i++, seq++) {
+    const HistoryRecord& record = historyRing[(oldest + i) % HISTORY_RECORDS];
+    if (i > 0) t += record.deltaMs;
+    // Project name only while the ID still belongs to the same project
+    const char* name = "";
+    if (record.project < projectCount && historyProjects[record.project].hash == projectTable[record.project].hash &&
+        seq >= historyProjects[record.project].firstSeq) {
+      name = projectTable[record.project].name;
+    }
+    snprintf(line, sizeof(line), "%s[%lu,", i > 0 ? "," : "", t);
+    out.print(line);
+    jsonPrintString(out, name);
+    snprintf(line, sizeof(line), ",\"%s\",", getStateString((AppState)record.state));
+    out.print(line);
+    jsonPrintString(out, getHistoryToolName(record.tool));
+    snprintf(line, sizeof(line), ",%d]", record.memory);
+    out.print(line);
+  }
+  out.print("]}");
+}
+
+#endif // HISTORY_H
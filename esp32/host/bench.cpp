@@ -0,0 +1,348 @@
+/*
+ * VibeMon Input Benchmark
+ * Replays corpus and synthetic status streams through processInput() and
+ * reports throughput, peak stack usage and heap allocations per stream
+ *
+ * Usage: bench [--iterations N] [--seed S] [corpus.jsonl ...]
+ */
+
+#include <chrono>
+#include <new>
+#include <pthread.h>
+#include <random>
+
+#include "replay.h"
+
+// =============================================================================
+// Allocation Counting
+// =============================================================================
+
+// Every heap allocation made by the firmware counts (the device heap is small
+// and fragments, so the input path is expected to stay at zero). On glibc the
+// malloc family is wrapped, which also covers operator new.
+static uint64_t allocCount = 0;
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+extern "C" void* malloc(size_t size) { allocCount++; return __libc_malloc(size); }
+extern "C" void* calloc(size_t count, size_t size) { allocCount++; return __libc_calloc(count, size); }
+extern "C" void* realloc(void* p, size_t size) { allocCount++; return __libc_realloc(p, size); }
+#endif
+
+void* operator new(size_t size) {
+#ifndef __GLIBC__
+  allocCount++;
+#endif
+  void* p = malloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// =============================================================================
+// Synthetic Streams
+// =============================================================================
+
+static const char* const STATES[] = {
+  "thinking", "planning", "working", "packing", "notification", "done", "idle", "alert"
+};
+static const char* const TOOLS[] = { "Bash", "Read", "Edit", "Write", "Grep", "WebFetch", "Task" };
+static const char* const MODELS[] = { "opus", "sonnet", "haiku" };
+
+static std::mt19937 rng(1);
+
+static int pick(int n) { return (int)(rng() % (uint32_t)n); }
+
+static std::string statusPayload(const char* project, const char* extra = "") {
+  char buf[256];
+  const char* state = STATES[pick(8)];
+  if (strcmp(state, "working") == 0) {
+    snprintf(buf, sizeof(buf),
+      "{\"state\":\"working\",\"project\":\"%s\",\"tool\":\"%s\",\"model\":\"%s\",\"memory\":%d%s}",
+      project, TOOLS[pick(7)], MODELS[pick(3)], pick(101), extra);
+  } else {
+    snprintf(buf, sizeof(buf), "{\"state\":\"%s\",\"project\":\"%s\",\"memory\":%d%s}",
+      state, project, pick(101), extra);
+  }
+  return buf;
+}
+
+static void addMessage(ReplayStream& stream, const std::string& payload,
+                       InputSource source = INPUT_SERIAL, uint32_t sourceId = 0,
+                       unsigned long gapMs = 100) {
+  stream.messages.push_back({payload, source, sourceId, gapMs * 1000});
+}
+
+// One session: a single project walking through hook states
+static ReplayStream syntheticSingleProject(int count) {
+  ReplayStream stream{"synthetic/single-project", {}};
+  for (int i = 0; i < count; i++) addMessage(stream, statusPayload("vibemon"));
+  return stream;
+}
+
+// More projects than MAX_PROJECTS, so the list evicts and the lock blocks
+static ReplayStream syntheticMultiProject(int count) {
+  ReplayStream stream{"synthetic/multi-project", {}};
+  char project[32];
+  for (int i = 0; i < count; i++) {
+    snprintf(project, sizeof(project), "project-%02d", pick(MAX_PROJECTS + 4));
+    addMessage(stream, statusPayload(project), INPUT_HTTP, 1 + pick(3), 50);
+  }
+  return stream;
+}
+
+// Status traffic interleaved with lock/unlock/status/metrics commands
+static ReplayStream syntheticCommands(int count) {
+  static const char* const COMMANDS[] = {
+    "{\"command\":\"lock\"}",
+    "{\"command\":\"lock\",\"project\":\"project-01\"}",
+    "{\"command\":\"unlock\"}",
+    "{\"command\":\"status\"}",
+    "{\"command\":\"metrics\"}",
+    "{\"command\":\"lock-mode\"}",
+    "{\"command\":\"lock-mode\",\"mode\":\"first-project\"}",
+    "{\"command\":\"lock-mode\",\"mode\":\"on-thinking\"}",
+  };
+  ReplayStream stream{"synthetic/commands", {}};
+  char project[32];
+  for (int i = 0; i < count; i++) {
+    if (pick(3) == 0) {
+      addMessage(stream, COMMANDS[pick(8)]);
+    } else {
+      snprintf(project, sizeof(project), "project-%02d", pick(3));
+      addMessage(stream, statusPayload(project));
+    }
+  }
+  return stream;
+}
+
+// Array payloads of 1..MAX_BATCH_ITEMS items, as posted by a batching hook
+static ReplayStream syntheticBatches(int count) {
+  ReplayStream stream{"synthetic/batches", {}};
+  char project[32];
+  for (int i = 0; i < count; i++) {
+    std::string payload = "[";
+    int items = 1 + pick(MAX_BATCH_ITEMS);
+    for (int j = 0; j < items; j++) {
+      snprintf(project, sizeof(project), "project-%02d", pick(2));
+      if (j > 0) payload += ",";
+      payload += statusPayload(project);
+    }
+    payload += "]";
+    addMessage(stream, payload, INPUT_HTTP, 1, 1000);
+  }
+  return stream;
+}
+
+// Each event delivered over HTTP and again via the WebSocket relay
+static ReplayStream syntheticDuplicates(int count) {
+  ReplayStream stream{"synthetic/duplicates", {}};
+  char extra[32];
+  for (int i = 0; i < count / 2; i++) {
+    snprintf(extra, sizeof(extra), ",\"eventId\":%d", i);
+    std::string payload = statusPayload("vibemon", extra);
+    addMessage(stream, payload, INPUT_HTTP, 1);
+    addMessage(stream, "{\"type\":\"status\",\"data\":" + payload + "}", INPUT_WEBSOCKET, 1, 5);
+  }
+  return stream;
+}
+
+// One HTTP client posting far above its rate limit
+static ReplayStream syntheticFlood(int count) {
+  ReplayStream stream{"synthetic/flood", {}};
+  for (int i = 0; i < count; i++) {
+    addMessage(stream, statusPayload(pick(4) == 0 ? "other" : "vibemon"), INPUT_HTTP, 7, 1);
+  }
+  return stream;
+}
+
+// Truncated, mistyped and oversized payloads
+static ReplayStream syntheticMalformed(int count) {
+  ReplayStream stream{"synthetic/malformed", {}};
+  std::string longName(200, 'x');
+  for (int i = 0; i < count; i++) {
+    std::string payload = statusPayload("vibemon");
+    switch (pick(6)) {
+      case 0: payload.resize(pick((int)payload.size())); break;
+      case 1: payload = "{\"state\":42,\"project\":[1,2],\"memory\":\"full\"}"; break;
+      case 2: payload = "{\"state\":\"working\",\"project\":\"" + longName + "\",\"tool\":\"" + longName + "\"}"; break;
+      case 3: payload = "{\"state\":\"bogus\",\"memory\":-5,\"character\":\"nobody\"}"; break;
+      case 4: payload = "[1,\"two\",null,{\"state\":\"done\"}]"; break;
+      default: break;
+    }
+    addMessage(stream, payload);
+  }
+  return stream;
+}
+
+// =============================================================================
+// Measurement
+// =============================================================================
+
+struct BenchResult {
+  ReplayCounters counters;
+  double seconds = 0;
+  size_t peakStack = 0;
+  uint64_t allocs = 0;
+  const char* violation = nullptr;
+};
+
+struct BenchJob {
+  const ReplayStream* stream;
+  int iterations;
+  BenchResult result;
+};
+
+static void* runReplay(void* arg) {
+  BenchJob& job = *(BenchJob*)arg;
+  uint64_t allocsBefore = allocCount;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < job.iterations; i++) {
+    beginReplay();
+    for (const ReplayMessage& msg : job.stream->messages) {
+      replayMessage(msg, job.result.counters);
+    }
+    drainStatusQueue();
+    if (!job.result.violation) job.result.violation = checkFirmwareInvariants();
+  }
+  auto end = std::chrono::steady_clock::now();
+  job.result.allocs = allocCount - allocsBefore;
+  job.result.seconds = std::chrono::duration<double>(end - start).count();
+  return nullptr;
+}
+
+// Run on a thread whose stack is pre-filled with a pattern; the deepest
+// overwritten byte gives the high-water mark
+static const size_t BENCH_STACK_SIZE = 1 << 20;
+static const uint8_t STACK_PAINT = 0xA5;
+
+static size_t runOnPaintedStack(BenchJob& job) {
+  void* stack = nullptr;
+  if (posix_memalign(&stack, 4096, BENCH_STACK_SIZE) != 0) return 0;
+  memset(stack, STACK_PAINT, BENCH_STACK_SIZE);
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, stack, BENCH_STACK_SIZE);
+  pthread_t thread;
+  pthread_create(&thread, &attr, runReplay, &job);
+  pthread_join(thread, nullptr);
+  pthread_attr_destroy(&attr);
+
+  // Stack grows down: scan up from the lowest address
+  const uint8_t* bytes = (const uint8_t*)stack;
+  size_t untouched = 0;
+  while (untouched < BENCH_STACK_SIZE && bytes[untouched] == STACK_PAINT) untouched++;
+  free(stack);
+  return BENCH_STACK_SIZE - untouched;
+}
+
+static BenchResult measure(const ReplayStream& stream, int iterations, size_t baselineStack) {
+  BenchJob job{&stream, iterations, {}};
+  size_t used = runOnPaintedStack(job);
+  job.result.peakStack = used > baselineStack ? used - baselineStack : 0;
+  return job.result;
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+static bool loadCorpusFile(const char* path, ReplayStream& stream) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  std::string text;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+  fclose(f);
+  stream.name = path;
+  parseReplayText(text.data(), text.size(), stream);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int iterations = 200;
+  std::vector<ReplayStream> streams;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      rng.seed((uint32_t)strtoul(argv[++i], nullptr, 10));
+    } else {
+      ReplayStream stream;
+      if (!loadCorpusFile(argv[i], stream)) {
+        fprintf(stderr, "{\"error\":\"cannot read %s\"}\n", argv[i]);
+        return 1;
+      }
+      streams.push_back(stream);
+    }
+  }
+  if (iterations < 1) iterations = 1;
+
+  streams.push_back(syntheticSingleProject(1000));
+  streams.push_back(syntheticMultiProject(1000));
+  streams.push_back(syntheticCommands(1000));
+  streams.push_back(syntheticBatches(200));
+  streams.push_back(syntheticDuplicates(1000));
+  streams.push_back(syntheticFlood(1000));
+  streams.push_back(syntheticMalformed(1000));
+
+  // Warm-up pass: resolves lazily bound symbols (the dynamic linker's resolver
+  // uses several KB of stack) so they don't count against the first stream
+  for (const ReplayStream& stream : streams) {
+    BenchJob warmup{&stream, 1, {}};
+    runOnPaintedStack(warmup);
+  }
+
+  // Stack used by the harness itself (thread start-up, replay loop frame)
+  ReplayStream empty;
+  BenchJob baselineJob{&empty, 1, {}};
+  size_t baselineStack = runOnPaintedStack(baselineJob);
+
+  printf("%-36s %8s %11s %8s %7s %7s %8s %8s %8s %8s %8s %8s %6s\n",
+    "stream", "msgs", "msgs/s", "ns/msg", "stackB", "allocs",
+    "applied", "blocked", "dup", "invalid", "throttle", "coalesce", "batch");
+
+  int failures = 0;
+  uint64_t totalMessages = 0;
+  double totalSeconds = 0;
+  size_t maxStack = 0;
+  uint64_t totalAllocs = 0;
+
+  for (const ReplayStream& stream : streams) {
+    BenchResult r = measure(stream, iterations, baselineStack);
+    const ReplayCounters& c = r.counters;
+    double perSec = r.seconds > 0 ? c.messages / r.seconds : 0;
+    double nsPerMsg = c.messages > 0 ? r.seconds * 1e9 / c.messages : 0;
+    printf("%-36s %8llu %11.0f %8.0f %7zu %7llu %8llu %8llu %8llu %8llu %8llu %8llu %6llu\n",
+      stream.name.c_str(), (unsigned long long)c.messages, perSec, nsPerMsg, r.peakStack,
+      (unsigned long long)r.allocs,
+      (unsigned long long)c.results[INPUT_APPLIED], (unsigned long long)c.results[INPUT_BLOCKED],
+      (unsigned long long)c.results[INPUT_DUPLICATE], (unsigned long long)c.results[INPUT_INVALID],
+      (unsigned long long)c.results[INPUT_THROTTLED], (unsigned long long)c.results[INPUT_COALESCED],
+      (unsigned long long)c.results[INPUT_BATCH]);
+    if (r.violation) {
+      fprintf(stderr, "{\"error\":\"invariant violated\",\"stream\":\"%s\",\"invariant\":\"%s\"}\n",
+        stream.name.c_str(), r.violation);
+      failures++;
+    }
+    totalMessages += c.messages;
+    totalSeconds += r.seconds;
+    totalAllocs += r.allocs;
+    if (r.peakStack > maxStack) maxStack = r.peakStack;
+  }
+
+  printf("%-36s %8llu %11.0f %8.0f %7zu %7llu\n", "total",
+    (unsigned long long)totalMessages, totalSeconds > 0 ? totalMessages / totalSeconds : 0,
+    totalMessages > 0 ? totalSeconds * 1e9 / totalMessages : 0, maxStack,
+    (unsigned long long)totalAllocs);
+  return failures > 0 ? 1 : 0;
+}
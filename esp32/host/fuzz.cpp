@@ -0,0 +1,65 @@
+/*
+ * VibeMon Input Fuzz Target
+ * Feeds arbitrary bytes through processInput() and aborts on any broken
+ * firmware invariant (project list bounds, valid state, terminated strings...)
+ *
+ * libFuzzer:  make fuzz && ./build/fuzz corpus/
+ * Standalone: make fuzz-replay (replays the corpus files, no libFuzzer needed)
+ */
+
+#include "replay.h"
+
+// Inputs are split into lines; each line is one payload. Unless the input
+// starts with a '#source' directive (corpus format), the transport and gap are
+// chosen by line position so de-dup and rate limiting are exercised.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  bool directed = size >= 7 && memcmp(data, "#source", 7) == 0;
+  ReplayStream stream;
+  parseReplayText((const char*)data, size, stream);
+
+  beginReplay();
+  ReplayCounters counters;
+  for (size_t i = 0; i < stream.messages.size(); i++) {
+    ReplayMessage& msg = stream.messages[i];
+    if (!directed) {
+      msg.source = (InputSource)(i % INPUT_SOURCE_COUNT);
+      msg.gapUs = (i % 4) * 40000;
+    }
+    replayMessage(msg, counters);
+
+    const char* violation = checkFirmwareInvariants();
+    if (violation) {
+      fprintf(stderr, "{\"error\":\"invariant violated\",\"invariant\":\"%s\",\"line\":%zu}\n",
+        violation, i + 1);
+      abort();
+    }
+
+    // Response builders must fit their buffers whatever the state holds
+    char buf[METRICS_JSON_SIZE];
+    buildStatusJson(buf, STATUS_JSON_SIZE);
+    buildMetricsJson(buf, sizeof(buf));
+    buildBatchResponseJson(buf, 64 + MAX_BATCH_ITEMS * 40);
+  }
+  return 0;
+}
+
+#ifndef VIBEMON_LIBFUZZER
+// Standalone driver: run each file given on the command line once
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    FILE* f = fopen(argv[i], "rb");
+    if (!f) {
+      fprintf(stderr, "{\"error\":\"cannot read %s\"}\n", argv[i]);
+      return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+    if (!data.empty()) LLVMFuzzerTestOneInput(data.data(), data.size());
+    printf("%s: ok\n", argv[i]);
+  }
+  return 0;
+}
+#endif
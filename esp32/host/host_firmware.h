@@ -0,0 +1,172 @@
+/*
+ * VibeMon Host Build
+ * Firmware modules compiled natively (no WiFi), plus state reset and
+ * invariant checks shared by the benchmark and fuzz targets
+ */
+
+#ifndef HOST_FIRMWARE_H
+#define HOST_FIRMWARE_H
+
+#include "TFT_Compat.h"
+#include <ArduinoJson.h>
+#include <Preferences.h>
+
+// Same module order as esp32.ino
+#include "config.h"
+#include "trace.h"
+#include "json_writer.h"
+#include "sprites.h"
+#include "ui_elements.h"
+#include "state.h"
+#include "settings.h"
+#include "display.h"
+#include "project_lock.h"
+#include "dashboard.h"
+#include "rotation.h"
+#include "session.h"
+#include "history.h"
+#include "dedup.h"
+#include "rate_limit.h"
+#include "latency.h"
+#include "ws_health.h"
+#include "status_queue.h"
+#include "input.h"
+
+// =============================================================================
+// State Reset
+// =============================================================================
+
+// Restore the input pipeline to its boot state (as after setup())
+inline void resetFirmwareState() {
+  hostResetClock();
+
+  currentState = STATE_START;
+  previousState = STATE_START;
+  safeCopyStr(currentCharacter, "clawd");
+  currentProject[0] = '\0';
+  currentTool[0] = '\0';
+  currentModel[0] = '\0';
+  currentMemory = 0;
+  lastActivityTime = 0;
+  needsRedraw = true;
+  dirtyCharacter = dirtyStatus = dirtyInfo = true;
+
+  memset(projectTable, 0, sizeof(projectTable));
+  resetProjectTable();
+
+  preferences.clear();
+  resetSettings(settings);
+  settingsDirty = false;
+  settingsWrittenCrc = 0;
+  settingsWrites = 0;
+
+  lockMode = LOCK_MODE_ON_THINKING;
+  viewMode = VIEW_MODE_SINGLE;
+  setRotationActive(false);
+  memset(rotationShownHash, 0, sizeof(rotationShownHash));
+  rotationSwitches = 0;
+  rotationPrecomposed = 0;
+
+  memset(&rtcSession, 0, sizeof(rtcSession));
+  sessionLastCheck = 0;
+  sessionNvsDirty = false;
+  sessionNvsWrittenAt = 0;
+  sessionNvsWrites = 0;
+
+  memset(historyProjects, 0, sizeof(historyProjects));
+  historyNext = 0;
+  historyCount = 0;
+  historyTotal = 0;
+  historyLastAt = 0;
+  historyToolCount = 0;
+
+  memset(dedupWindow, 0, sizeof(dedupWindow));
+  dedupCount = 0;
+  dedupNext = 0;
+  memset(dedupSuppressed, 0, sizeof(dedupSuppressed));
+
+  memset(rateBuckets, 0, sizeof(rateBuckets));
+  memset(rateAdmitted, 0, sizeof(rateAdmitted));
+  memset(rateCoalesced, 0, sizeof(rateCoalesced));
+  memset(rateDropped, 0, sizeof(rateDropped));
+
+  memset(laneStats, 0, sizeof(laneStats));
+  resetLatencyStats();
+  probePendingCount = 0;
+  statusQueueHead = 0;
+  statusQueueLen = 0;
+  statusCoalesced = 0;
+  statusDropped = 0;
+  batchCount = 0;
+}
+
+// =============================================================================
+// Invariants
+// =============================================================================
+
+// NUL-terminated within its buffer
+#define HOST_TERMINATED(buf) (strnlen(buf, sizeof(buf)) < sizeof(buf))
+
+// Project table: every entry reachable through the hash index and the LRU
+// list exactly once, names unique, lock pointing at a live entry
+inline const char* checkProjectTable() {
+  if (projectCount < 0 || projectCount > MAX_PROJECTS) return "projectCount <= MAX_PROJECTS";
+  for (int i = 0; i < projectCount; i++) {
+    const ProjectEntry& entry = projectTable[i];
+    if (!HOST_TERMINATED(entry.name)) return "project name terminated";
+    if (entry.name[0] == '\0') return "project name non-empty";
+    if (entry.hash != fnv1a(entry.name)) return "project hash matches name";
+    if (findProject(entry.name) != i) return "project found by hash index";
+    const ProjectSnapshot& snapshot = entry.snapshot;
+    if (snapshot.state > STATE_ALERT || snapshot.memory > 100) return "project snapshot valid";
+    if (!HOST_TERMINATED(snapshot.tool) || !HOST_TERMINATED(snapshot.model) ||
+        !HOST_TERMINATED(snapshot.character)) return "project snapshot strings terminated";
+  }
+
+  int chained = 0;
+  for (int b = 0; b < PROJECT_HASH_BUCKETS; b++) {
+    for (ProjectId id = projectBuckets[b]; id != PROJECT_NONE; id = projectTable[id].nextInBucket) {
+      if (id >= projectCount || ++chained > projectCount) return "hash chains well-formed";
+    }
+  }
+  if (chained != projectCount) return "hash chains cover every project";
+
+  int listed = 0;
+  ProjectId prev = PROJECT_NONE;
+  for (ProjectId id = projectLruHead; id != PROJECT_NONE; id = projectTable[id].lruNext) {
+    if (id >= projectCount || ++listed > projectCount) return "LRU list well-formed";
+    if (projectTable[id].lruPrev != prev) return "LRU back links";
+    prev = id;
+  }
+  if (listed != projectCount || projectLruTail != prev) return "LRU list covers every project";
+
+  if (lockedProjectId != PROJECT_NONE && lockedProjectId >= projectCount) return "locked project is live";
+  return nullptr;
+}
+
+// Returns the first violated invariant, or nullptr if the state is consistent
+inline const char* checkFirmwareInvariants() {
+  const char* tableViolation = checkProjectTable();
+  if (tableViolation) return tableViolation;
+  if (currentState < STATE_START || currentState > STATE_ALERT) return "currentState valid";
+  if (previousState < STATE_START || previousState > STATE_ALERT) return "previousState valid";
+  if (currentMemory < 0 || currentMemory > 100) return "currentMemory in 0-100";
+  if (!HOST_TERMINATED(currentProject) || !HOST_TERMINATED(currentTool) ||
+      !HOST_TERMINATED(currentModel) ||
+      !HOST_TERMINATED(currentCharacter)) return "state strings terminated";
+  if (!isValidCharacter(currentCharacter)) return "currentCharacter valid";
+  if (lockMode != LOCK_MODE_FIRST_PROJECT && lockMode != LOCK_MODE_ON_THINKING) return "lockMode valid";
+  if (statusQueueLen > STATUS_QUEUE_SIZE || statusQueueHead >= STATUS_QUEUE_SIZE) return "status queue bounds";
+  for (uint8_t i = 0; i < statusQueueLen; i++) {
+    const StatusUpdate& queued = statusQueue[(statusQueueHead + i) % STATUS_QUEUE_SIZE];
+    if (queued.state > STATE_ALERT || queued.memory > 100) return "queued update valid";
+    if (queued.projectId < PROJECT_EVICTED && queued.projectId >= projectCount) return "queued project ID valid";
+  }
+  if (dedupCount > DEDUP_WINDOW_SIZE || dedupNext >= DEDUP_WINDOW_SIZE) return "dedup window bounds";
+  if (batchCount > MAX_BATCH_ITEMS) return "batchCount <= MAX_BATCH_ITEMS";
+  if (historyCount > HISTORY_RECORDS || historyNext >= HISTORY_RECORDS) return "history ring bounds";
+  if (historyToolCount >= HISTORY_TOOLS) return "history tool table bounds";
+  return nullptr;
+}
+
+#endif // HOST_FIRMWARE_H
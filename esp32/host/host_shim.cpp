@@ -0,0 +1,16 @@
+/*
+ * VibeMon Host Shim: Arduino globals and virtual clock
+ */
+
+#include "Arduino.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static unsigned long hostMicros = 0;
+
+unsigned long millis() { return hostMicros / 1000; }
+unsigned long micros() { return hostMicros; }
+void delay(unsigned long ms) { hostMicros += ms * 1000; }
+void hostAdvanceMicros(unsigned long us) { hostMicros += us; }
+void hostResetClock() { hostMicros = 0; }
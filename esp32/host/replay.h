@@ -0,0 +1,104 @@
+/*
+ * VibeMon Host Replay
+ * Status streams (corpus files or synthetic) fed through processInput()
+ * the way loop() would see them
+ */
+
+#ifndef HOST_REPLAY_H
+#define HOST_REPLAY_H
+
+#include <string>
+#include <vector>
+
+#include "host_firmware.h"
+
+// =============================================================================
+// Stream Format
+// =============================================================================
+
+// One payload as received by a transport, gapUs after the previous one
+struct ReplayMessage {
+  std::string payload;
+  InputSource source;
+  uint32_t sourceId;
+  unsigned long gapUs;
+};
+
+struct ReplayStream {
+  std::string name;
+  std::vector<ReplayMessage> messages;
+};
+
+// Corpus files are JSONL: one payload per line, as sent by a hook or relay.
+// Lines starting with '#' are directives for the lines that follow:
+//   #source <transport> [id]   transport (serial, http, websocket, udp, websocket-lan)
+//                              and source ID (default: serial 0)
+//   #gap <ms>                  time since the previous payload (default: 100)
+// Any other '#' line is a comment.
+inline void parseReplayText(const char* text, size_t size, ReplayStream& stream) {
+  InputSource source = INPUT_SERIAL;
+  uint32_t sourceId = 0;
+  unsigned long gapUs = 100000;
+
+  size_t pos = 0;
+  while (pos < size) {
+    size_t end = pos;
+    while (end < size && text[end] != '\n') end++;
+    std::string line(text + pos, end - pos);
+    pos = end + 1;
+
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty()) continue;
+
+    if (line[0] == '#') {
+      char name[16] = "";
+      unsigned long value = 0;
+      if (sscanf(line.c_str(), "#source %15s %lu", name, &value) >= 1) {
+        if (strcmp(name, "http") == 0) source = INPUT_HTTP;
+        else if (strcmp(name, "websocket") == 0) source = INPUT_WEBSOCKET;
+        else if (strcmp(name, "udp") == 0) source = INPUT_UDP;
+        else if (strcmp(name, "websocket-lan") == 0) source = INPUT_WEBSOCKET_LAN;
+        else source = INPUT_SERIAL;
+        sourceId = (uint32_t)value;
+      } else if (sscanf(line.c_str(), "#gap %lu", &value) == 1) {
+        gapUs = value * 1000;
+      }
+      continue;
+    }
+    stream.messages.push_back({line, source, sourceId, gapUs});
+  }
+}
+
+// =============================================================================
+// Replay
+// =============================================================================
+
+struct ReplayCounters {
+  uint64_t messages = 0;
+  uint64_t results[INPUT_BATCH + 1] = {0};
+};
+
+// Virtual time of the last simulated loop() iteration
+unsigned long replayLastLoop = 0;
+
+inline void beginReplay() {
+  resetFirmwareState();
+  replayLastLoop = 0;
+}
+
+// Deliver one payload, then run the queue drain whenever a loop() iteration
+// would have happened in the elapsed virtual time
+inline InputResult replayMessage(const ReplayMessage& msg, ReplayCounters& counters) {
+  hostAdvanceMicros(msg.gapUs);
+  InputResult result = processInput(msg.payload.c_str(), msg.source, msg.sourceId);
+  counters.messages++;
+  counters.results[result]++;
+
+  if (millis() - replayLastLoop >= (unsigned long)getLoopDelay()) {
+    drainStatusQueue();
+    replayLastLoop = millis();
+  }
+  return result;
+}
+
+#endif // HOST_REPLAY_H
@@ -0,0 +1,161 @@
+/*
+ * VibeMon Host Shim: Arduino core
+ * Just enough of the ESP32 Arduino core to compile the firmware modules natively
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define PROGMEM
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define F(x) x
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+
+// =============================================================================
+// Virtual Clock (host_shim.cpp)
+// =============================================================================
+
+// millis()/micros() return a virtual clock that only moves when the harness
+// advances it (or the firmware calls delay()), so runs are deterministic.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void hostAdvanceMicros(unsigned long us);
+void hostResetClock();
+
+inline void yield() {}
+inline void setCpuFrequencyMhz(int) {}
+inline uint32_t esp_random() { return (uint32_t)rand(); }
+inline long random(long howbig) { return howbig > 0 ? rand() % howbig : 0; }
+inline long random(long howsmall, long howbig) { return howsmall + random(howbig - howsmall); }
+
+template <class T, class L, class H>
+T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+// =============================================================================
+// String / Print
+// =============================================================================
+
+class String {
+ public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(int v) : s_(std::to_string(v)) {}
+  String(unsigned long v) : s_(std::to_string(v)) {}
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  char operator[](unsigned int i) const { return s_[i]; }
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String& operator+=(const char* o) { s_ += o; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  bool operator==(const char* o) const { return s_ == o; }
+
+ private:
+  std::string s_;
+};
+
+class Print;
+
+class Printable {
+ public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    for (size_t i = 0; i < n; i++) write(buf[i]);
+    return n;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned int v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  size_t print(const Printable& v) { return v.printTo(*this); }
+  template <class T>
+  size_t println(const T& v) { return print(v) + println(); }
+  size_t println() { return write("\r\n"); }
+  size_t printf(const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return n > 0 ? write(buf) : 0;
+  }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+};
+
+// Serial output goes to stdout only when Serial.echo is set (off for
+// benchmarks and fuzzing). Input is whatever the harness queued with
+// hostInput() (the simulator feeds loop() this way).
+class HardwareSerial : public Stream {
+ public:
+  bool echo = false;
+  void begin(unsigned long) {}
+  int available() override { return (int)(input_.size() - inputPos_); }
+  int read() override { return inputPos_ < input_.size() ? (uint8_t)input_[inputPos_++] : -1; }
+  void hostInput(const std::string& data) {
+    input_.erase(0, inputPos_);
+    inputPos_ = 0;
+    input_ += data;
+  }
+  size_t write(uint8_t c) override {
+    if (echo) putchar(c);
+    return 1;
+  }
+  size_t write(const uint8_t* buf, size_t n) override {
+    if (echo) fwrite(buf, 1, n, stdout);
+    return n;
+  }
+  using Print::write;
+  operator bool() const { return true; }
+
+ private:
+  std::string input_;
+  size_t inputPos_ = 0;
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+ public:
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMinFreeHeap() { return 0; }
+  uint32_t getMaxAllocHeap() { return 0; }
+  void restart() {}
+};
+extern EspClass ESP;
+
+#endif // ARDUINO_H
@@ -0,0 +1,18 @@
+/*
+ * VibeMon Host Shim: DNSServer
+ * Captive portal DNS that never receives a query
+ */
+
+#ifndef DNSSERVER_H
+#define DNSSERVER_H
+
+#include "WiFi.h"
+
+class DNSServer {
+ public:
+  bool start(uint16_t, const char*, IPAddress) { return true; }
+  void processNextRequest() {}
+  void stop() {}
+};
+
+#endif // DNSSERVER_H
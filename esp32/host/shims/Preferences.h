@@ -0,0 +1,66 @@
+/*
+ * VibeMon Host Shim: Preferences
+ * In-memory NVS stand-in (contents are lost when the process exits)
+ */
+
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+class Preferences {
+ public:
+  bool begin(const char*, bool readOnly = false) { (void)readOnly; return true; }
+  void end() {}
+
+  int32_t getInt(const char* key, int32_t defaultValue = 0) {
+    auto it = values_.find(key);
+    return it == values_.end() ? defaultValue : (int32_t)it->second;
+  }
+  size_t putInt(const char* key, int32_t value) { values_[key] = value; return sizeof(value); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) {
+    auto it = values_.find(key);
+    return it == values_.end() ? defaultValue : (uint32_t)it->second;
+  }
+  size_t putUInt(const char* key, uint32_t value) { values_[key] = value; return sizeof(value); }
+  bool getBool(const char* key, bool defaultValue = false) { return getUInt(key, defaultValue) != 0; }
+  size_t putBool(const char* key, bool value) { return putUInt(key, value); }
+
+  size_t getString(const char* key, char* buf, size_t size) {
+    auto it = strings_.find(key);
+    if (it == strings_.end() || size == 0) return 0;
+    strncpy(buf, it->second.c_str(), size - 1);
+    buf[size - 1] = '\0';
+    return strlen(buf) + 1;
+  }
+  size_t putString(const char* key, const char* value) { strings_[key] = value; return strlen(value); }
+
+  size_t getBytesLength(const char* key) {
+    auto it = bytes_.find(key);
+    return it == bytes_.end() ? 0 : it->second.size();
+  }
+  size_t getBytes(const char* key, void* buf, size_t size) {
+    auto it = bytes_.find(key);
+    if (it == bytes_.end() || it->second.size() > size) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  size_t putBytes(const char* key, const void* value, size_t size) {
+    bytes_[key].assign((const uint8_t*)value, (const uint8_t*)value + size);
+    return size;
+  }
+
+  bool isKey(const char* key) { return values_.count(key) || strings_.count(key) || bytes_.count(key); }
+  bool remove(const char* key) { return values_.erase(key) + strings_.erase(key) + bytes_.erase(key) > 0; }
+  bool clear() { values_.clear(); strings_.clear(); bytes_.clear(); return true; }
+
+ private:
+  std::map<std::string, int64_t> values_;
+  std::map<std::string, std::string> strings_;
+  std::map<std::string, std::vector<uint8_t>> bytes_;
+};
+
+#endif // PREFERENCES_H
@@ -0,0 +1,143 @@
+/*
+ * VibeMon Host Shim: TFT_Compat.h
+ * Replaces the LovyanGFX wrapper with a display that discards every draw
+ * call, counting what would reach the panel (same include guard, so
+ * esp32/TFT_Compat.h is never used)
+ */
+
+#ifndef TFT_COMPAT_H
+#define TFT_COMPAT_H
+
+#include "Arduino.h"
+
+namespace fonts {
+struct GFXfont {};
+static const GFXfont FreeSans9pt7b = {};
+}
+
+// Pixels written to the panel (sprite drawing stays in RAM until pushed).
+// Shapes count their area or outline, text its glyph cells: an estimate of
+// SPI traffic at 2 bytes per RGB565 pixel, command bytes not included.
+struct HostPanelStats {
+  uint64_t pixels = 0;
+  uint64_t writes = 0;    // Draw calls / sprite pushes that reached the panel
+  int brightness = 0;     // Last setBrightness()
+};
+inline HostPanelStats hostPanel;
+
+// Draw calls are no-ops (variadic where the size doesn't matter, so any
+// LovyanGFX overload compiles); on the panel they add to hostPanel
+class HostCanvas : public Print {
+ public:
+  size_t write(uint8_t) override { countPixels(6L * 8 * textSize_ * textSize_); return 1; }
+  using Print::write;
+
+  template <class... A> void init(A...) {}
+  template <class... A> void setRotation(A...) {}
+  template <class... A> void setSwapBytes(A...) {}
+  void setBrightness(int brightness) { if (panel_) hostPanel.brightness = brightness; }
+  template <class... A> void setColorDepth(A...) {}
+  template <class... A> void startWrite(A...) {}
+  template <class... A> void endWrite(A...) {}
+  template <class... A> void fillScreen(A...) { countPixels((long)width() * height()); }
+  template <class... A> void fillSprite(A...) {}
+  template <class... A> void fillRect(int, int, int w, int h, A...) { countPixels((long)w * h); }
+  template <class... A> void drawRect(int, int, int w, int h, A...) { countPixels(2L * (w + h)); }
+  template <class... A> void fillRoundRect(int, int, int w, int h, A...) { countPixels((long)w * h); }
+  template <class... A> void drawRoundRect(int, int, int w, int h, A...) { countPixels(2L * (w + h)); }
+  template <class... A> void fillCircle(int, int, int r, A...) { countPixels(3L * r * r + 1); }
+  template <class... A> void drawCircle(int, int, int r, A...) { countPixels(6L * r + 1); }
+  template <class... A> void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, A...) {
+    countPixels(labs((long)(x1 - x0) * (y2 - y0) - (long)(x2 - x0) * (y1 - y0)) / 2 + 1);
+  }
+  template <class... A> void drawLine(int x0, int y0, int x1, int y1, A...) {
+    countPixels(std::max(labs((long)x1 - x0), labs((long)y1 - y0)) + 1);
+  }
+  template <class... A> void drawFastVLine(int, int, int h, A...) { countPixels(h); }
+  template <class... A> void drawFastHLine(int, int, int w, A...) { countPixels(w); }
+  template <class... A> void drawPixel(A...) { countPixels(1); }
+  template <class... A> void pushImage(int, int, int w, int h, A...) { countPixels((long)w * h); }
+  template <class... A> void setTextColor(A...) {}
+  void setTextSize(int size) { textSize_ = size; }
+  template <class... A> void setTextDatum(A...) {}
+  template <class... A> void setCursor(A...) {}
+  template <class... A> void setFont(A...) {}
+  template <class... A> void drawString(const char* s, A...) { countPixels((long)textWidth(s) * fontHeight()); }
+  int textWidth(const char* s) { return (int)strlen(s) * 6 * textSize_; }
+  int fontHeight() { return 8 * textSize_; }
+  int width() const { return 172; }
+  int height() const { return 320; }
+
+ protected:
+  bool panel_ = false;
+  int textSize_ = 1;
+
+  void countPixels(long pixels) {
+    if (!panel_ || pixels <= 0) return;
+    hostPanel.pixels += (uint64_t)pixels;
+    hostPanel.writes++;
+  }
+};
+
+class LGFX : public HostCanvas {
+ public:
+  LGFX() { panel_ = true; }
+};
+
+namespace lgfx {
+class LGFX_Sprite : public HostCanvas {
+ public:
+  LGFX_Sprite(LGFX* parent = nullptr) { (void)parent; }
+  void* createSprite(int w, int h) { width_ = w; height_ = h; return this; }
+  void deleteSprite() { width_ = height_ = 0; }
+  // Every sprite in the firmware is pushed to the panel
+  template <class... A> void pushSprite(A...) {
+    hostPanel.pixels += (uint64_t)width_ * height_;
+    hostPanel.writes++;
+  }
+  template <class... A> void pushRotateZoomWithAA(A...) {}  // Into another sprite
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+ private:
+  int width_ = 0;
+  int height_ = 0;
+};
+}
+
+static LGFX tft;
+
+// TFT_eSPI color definitions (RGB565)
+#define TFT_BLACK       0x0000
+#define TFT_WHITE       0xFFFF
+#define TFT_RED         0xF800
+#define TFT_GREEN       0x07E0
+#define TFT_BLUE        0x001F
+#define TFT_YELLOW      0xFFE0
+#define TFT_CYAN        0x07FF
+#define TFT_MAGENTA     0xF81F
+#define TFT_ORANGE      0xFD20
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xC618
+#define TFT_DARKGREY    0x7BEF
+
+// Text datum definitions (same as TFT_eSPI)
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+using TFT_eSPI = LGFX;
+using TFT_eSprite = lgfx::LGFX_Sprite;
+
+#endif // TFT_COMPAT_H
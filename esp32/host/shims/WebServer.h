@@ -0,0 +1,41 @@
+/*
+ * VibeMon Host Shim: WebServer
+ * Provisioning portal server that never receives a request
+ */
+
+#ifndef WEBSERVER_H
+#define WEBSERVER_H
+
+#include <functional>
+#include "WiFi.h"
+
+typedef enum { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS } HTTPMethod;
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+class WebServer {
+ public:
+  typedef std::function<void(void)> THandlerFunction;
+  WebServer(int = 80) {}
+  void begin() {}
+  void stop() {}
+  void close() {}
+  void handleClient() {}
+  void on(const char*, HTTPMethod, THandlerFunction) {}
+  void on(const char*, THandlerFunction) {}
+  void onNotFound(THandlerFunction) {}
+  bool hasArg(const char*) { return false; }
+  String arg(const char*) { return String(); }
+  String uri() { return String(); }
+  HTTPMethod method() { return HTTP_GET; }
+  void send(int, const char* = nullptr, const char* = nullptr) {}
+  void send(int, const char*, const String&) {}
+  void send_P(int, const char*, const char*) {}
+  void setContentLength(size_t) {}
+  void sendHeader(const char*, const char*, bool = false) {}
+  void sendContent(const char*) {}
+  void sendContent(const char*, size_t) {}
+  void sendContent(const String&) {}
+  WiFiClient client() { return WiFiClient(); }
+};
+
+#endif // WEBSERVER_H
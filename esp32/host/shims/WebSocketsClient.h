@@ -0,0 +1,358 @@
+/*
+ * VibeMon Host Shim: WebSocketsClient
+ * Plain-TCP WebSocket client (RFC 6455) with the behaviour of the links2004
+ * library that the firmware relies on, for the soak harness against
+ * tools/ws_relay.py:
+ * - everything happens in loop(); only the TCP connect blocks (loopback)
+ * - after a failed connect or a disconnect, the next attempt waits for
+ *   setReconnectInterval() (the value set when the wait ends counts)
+ * - WStype_DISCONNECTED whenever an opened TCP connection closes, also when
+ *   the handshake is refused (401); a refused TCP connect raises no event
+ * - pings are answered automatically, then reported as WStype_PING
+ * TLS (beginSSL) and fragmented messages are not supported.
+ */
+
+#ifndef WEBSOCKETSCLIENT_H
+#define WEBSOCKETSCLIENT_H
+
+#include <cerrno>
+#include <functional>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "WiFi.h"
+
+typedef enum {
+  WStype_ERROR, WStype_DISCONNECTED, WStype_CONNECTED, WStype_TEXT, WStype_BIN,
+  WStype_FRAGMENT_TEXT_START, WStype_FRAGMENT_BIN_START, WStype_FRAGMENT, WStype_FRAGMENT_FIN,
+  WStype_PING, WStype_PONG
+} WStype_t;
+
+#define HOST_WS_TCP_TIMEOUT   5000  // Connect and handshake timeout (ms), as the library
+#define HOST_WS_RX_SIZE       8192
+#define HOST_WS_MAX_PAYLOAD   4096
+
+// Connection counters for the harness report
+struct HostWsStats {
+  uint32_t begins = 0;            // begin() calls (setup and every re-init)
+  uint32_t tcpFailures = 0;       // Connect refused or timed out
+  uint32_t handshakeFailures = 0; // Opened, but no 101 (auth error, timeout)
+  uint32_t connects = 0;          // Handshakes completed
+  uint32_t disconnects = 0;       // WStype_DISCONNECTED raised
+  uint32_t framesIn = 0;
+  uint32_t framesOut = 0;
+  uint32_t sendFailures = 0;
+};
+
+class WebSocketsClient {
+ public:
+  typedef std::function<void(WStype_t type, uint8_t* payload, size_t length)> WebSocketClientEvent;
+
+  // Sees every event before the firmware's handler (harness bookkeeping)
+  WebSocketClientEvent hostObserver;
+  HostWsStats hostStats;
+
+  ~WebSocketsClient() { closeSocket(); }
+
+  void begin(const char* host, uint16_t port, const char* url = "/", const char* protocol = "arduino") {
+    (void)protocol;
+    snprintf(host_, sizeof(host_), "%s", host);
+    snprintf(url_, sizeof(url_), "%s", url);
+    port_ = port;
+    begun_ = true;
+    retryWait_ = false;  // First attempt at the next loop()
+    hostStats.begins++;
+  }
+
+  void beginSSL(const char* host, uint16_t port, const char* url = "/", const char* = "", const char* = "arduino") {
+    fprintf(stderr, "{\"error\":\"TLS not available on the host (WS_USE_SSL false)\",\"host\":\"%s\",\"port\":%u,\"url\":\"%s\"}\n",
+      host, port, url);
+    begun_ = false;
+  }
+
+  void onEvent(WebSocketClientEvent cb) { cb_ = cb; }
+  void setReconnectInterval(unsigned long ms) { reconnectInterval_ = ms; }
+  void enableHeartbeat(uint32_t, uint32_t, uint8_t) {}  // Not modelled (the firmware runs its own)
+  void disableHeartbeat() {}
+  bool isConnected() { return state_ == CONNECTED; }
+
+  bool sendTXT(const char* payload, size_t length) { return sendFrame(0x1, (const uint8_t*)payload, length); }
+  bool sendTXT(const char* payload) { return sendTXT(payload, strlen(payload)); }
+  bool sendPing(uint8_t* payload = nullptr, size_t length = 0) { return sendFrame(0x9, payload, length); }
+
+  void disconnect() {
+    if (state_ == CONNECTED) {
+      static const uint8_t NORMAL[2] = { 0x03, 0xE8 };  // 1000
+      sendFrame(0x8, NORMAL, sizeof(NORMAL));
+    }
+    closeSocket();
+  }
+
+  void loop() {
+    if (!begun_) return;
+    if (fd_ < 0) {
+      if (retryWait_ && millis() - failedAt_ < reconnectInterval_) return;
+      openSocket();
+      return;
+    }
+    receive();
+    if (state_ == HANDSHAKE && fd_ >= 0 && millis() - openedAt_ >= HOST_WS_TCP_TIMEOUT) {
+      hostStats.handshakeFailures++;
+      closeSocket();
+    }
+  }
+
+ private:
+  enum State { IDLE, HANDSHAKE, CONNECTED };
+
+  WebSocketClientEvent cb_;
+  char host_[64] = "";
+  char url_[256] = "/";
+  uint16_t port_ = 0;
+  bool begun_ = false;
+  int fd_ = -1;
+  State state_ = IDLE;
+  unsigned long reconnectInterval_ = 500;  // Library default
+  unsigned long failedAt_ = 0;
+  bool retryWait_ = false;
+  unsigned long openedAt_ = 0;
+  uint8_t rx_[HOST_WS_RX_SIZE];
+  size_t rxLen_ = 0;
+  uint8_t payload_[HOST_WS_MAX_PAYLOAD + 1];  // +1: text is NUL-terminated
+
+  void dispatch(WStype_t type, uint8_t* payload, size_t length) {
+    if (hostObserver) hostObserver(type, payload, length);
+    if (cb_) cb_(type, payload, length);
+  }
+
+  void scheduleRetry() {
+    failedAt_ = millis();
+    retryWait_ = true;
+  }
+
+  void openSocket() {
+    char port[8];
+    snprintf(port, sizeof(port), "%u", port_);
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addrs = nullptr;
+    if (getaddrinfo(host_, port, &hints, &addrs) != 0 || !addrs) {
+      hostStats.tcpFailures++;
+      scheduleRetry();
+      return;
+    }
+
+    int fd = socket(addrs->ai_family, SOCK_STREAM, 0);
+    bool ok = fd >= 0;
+    if (ok) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      int rc = connect(fd, addrs->ai_addr, addrs->ai_addrlen);
+      if (rc != 0 && errno == EINPROGRESS) {
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        int err = 0;
+        socklen_t len = sizeof(err);
+        rc = (poll(&pfd, 1, HOST_WS_TCP_TIMEOUT) == 1 &&
+              getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) ? 0 : -1;
+      }
+      ok = rc == 0;
+    }
+    freeaddrinfo(addrs);
+    if (!ok) {
+      if (fd >= 0) close(fd);
+      hostStats.tcpFailures++;
+      scheduleRetry();
+      return;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // Handshake (the accept key is not verified: the relay is ours)
+    static const char B64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char key[25];
+    for (int i = 0; i < 22; i++) key[i] = B64[esp_random() % 64];
+    key[21] = B64[(esp_random() % 4) * 16];  // 16 bytes: last char carries 2 bits
+    key[22] = key[23] = '=';
+    key[24] = '\0';
+    char request[512];
+    int n = snprintf(request, sizeof(request),
+      "GET %s HTTP/1.1\r\nHost: %s:%u\r\nConnection: Upgrade\r\nUpgrade: websocket\r\n"
+      "Sec-WebSocket-Version: 13\r\nSec-WebSocket-Key: %s\r\nSec-WebSocket-Protocol: arduino\r\n"
+      "User-Agent: arduino-WebSocket-Client\r\n\r\n",
+      url_, host_, port_, key);
+    fd_ = fd;
+    state_ = HANDSHAKE;
+    openedAt_ = millis();
+    rxLen_ = 0;
+    if (!writeAll((const uint8_t*)request, n)) {
+      hostStats.handshakeFailures++;
+      closeSocket();
+    }
+  }
+
+  // Close and raise DISCONNECTED (the connection had been opened)
+  void closeSocket() {
+    if (fd_ < 0) return;
+    close(fd_);
+    fd_ = -1;
+    state_ = IDLE;
+    rxLen_ = 0;
+    scheduleRetry();
+    hostStats.disconnects++;
+    dispatch(WStype_DISCONNECTED, nullptr, 0);
+  }
+
+  bool writeAll(const uint8_t* data, size_t len) {
+    while (len > 0) {
+      ssize_t n = send(fd_, data, len, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0 && errno == EAGAIN) {
+        // Loopback send buffer full: wait briefly, as the library's blocking write
+        struct pollfd pfd = { fd_, POLLOUT, 0 };
+        if (poll(&pfd, 1, HOST_WS_TCP_TIMEOUT) == 1) continue;
+      }
+      if (n <= 0) return false;
+      data += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  // Client frames are masked (RFC 6455 5.3)
+  bool sendFrame(uint8_t opcode, const uint8_t* payload, size_t length) {
+    if (state_ != CONNECTED || length > HOST_WS_MAX_PAYLOAD) return false;
+    uint8_t frame[14 + HOST_WS_MAX_PAYLOAD];
+    size_t pos = 0;
+    frame[pos++] = 0x80 | opcode;
+    if (length < 126) {
+      frame[pos++] = 0x80 | (uint8_t)length;
+    } else {
+      frame[pos++] = 0x80 | 126;
+      frame[pos++] = (length >> 8) & 0xFF;
+      frame[pos++] = length & 0xFF;
+    }
+    uint32_t mask = esp_random();
+    uint8_t* key = frame + pos;
+    memcpy(key, &mask, 4);
+    pos += 4;
+    for (size_t i = 0; i < length; i++) frame[pos++] = payload[i] ^ key[i & 3];
+    if (!writeAll(frame, pos)) {
+      hostStats.sendFailures++;
+      closeSocket();
+      return false;
+    }
+    hostStats.framesOut++;
+    return true;
+  }
+
+  void receive() {
+    while (fd_ >= 0) {
+      if (rxLen_ == sizeof(rx_)) {
+        closeSocket();  // Frame larger than the buffer
+        return;
+      }
+      ssize_t n = recv(fd_, rx_ + rxLen_, sizeof(rx_) - rxLen_, 0);
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+      if (n <= 0) {
+        closeSocket();  // Closed by the relay, or reset
+        return;
+      }
+      rxLen_ += n;
+      size_t used = state_ == HANDSHAKE ? parseHandshake() : parseFrames();
+      if (fd_ < 0) return;
+      memmove(rx_, rx_ + used, rxLen_ - used);
+      rxLen_ -= used;
+    }
+  }
+
+  size_t parseHandshake() {
+    const uint8_t* end = nullptr;
+    for (size_t i = 3; i < rxLen_; i++) {
+      if (memcmp(rx_ + i - 3, "\r\n\r\n", 4) == 0) {
+        end = rx_ + i + 1;
+        break;
+      }
+    }
+    if (!end) return 0;
+    if (rxLen_ < 12 || memcmp(rx_, "HTTP/1.1 101", 12) != 0) {
+      hostStats.handshakeFailures++;
+      closeSocket();
+      return 0;
+    }
+    state_ = CONNECTED;
+    hostStats.connects++;
+    size_t used = end - rx_;
+    dispatch(WStype_CONNECTED, (uint8_t*)url_, strlen(url_));
+    if (fd_ < 0) return 0;
+    // Frames sent right after the 101 arrive in the same read
+    size_t rest = rxLen_ - used;
+    memmove(rx_, rx_ + used, rest);
+    rxLen_ = rest;
+    return parseFrames();
+  }
+
+  // Complete frames from rx_; returns the bytes consumed
+  size_t parseFrames() {
+    size_t pos = 0;
+    while (fd_ >= 0 && rxLen_ - pos >= 2) {
+      const uint8_t* f = rx_ + pos;
+      uint8_t opcode = f[0] & 0x0F;
+      bool masked = f[1] & 0x80;
+      size_t length = f[1] & 0x7F;
+      size_t head = 2;
+      if (length == 126) {
+        if (rxLen_ - pos < 4) break;
+        length = ((size_t)f[2] << 8) | f[3];
+        head = 4;
+      } else if (length == 127) {
+        closeSocket();  // Never sent by the relay
+        return 0;
+      }
+      if (masked) head += 4;
+      if (length > HOST_WS_MAX_PAYLOAD || !(f[0] & 0x80)) {
+        closeSocket();  // Oversized or fragmented
+        return 0;
+      }
+      if (rxLen_ - pos < head + length) break;
+
+      memcpy(payload_, f + head, length);
+      if (masked) {
+        for (size_t i = 0; i < length; i++) payload_[i] ^= f[head - 4 + (i & 3)];
+      }
+      payload_[length] = '\0';
+      pos += head + length;
+      hostStats.framesIn++;
+
+      switch (opcode) {
+        case 0x1:
+          dispatch(WStype_TEXT, payload_, length);
+          break;
+        case 0x2:
+          dispatch(WStype_BIN, payload_, length);
+          break;
+        case 0x8:
+          disconnect();  // Echo the close, then drop the connection
+          return 0;
+        case 0x9:
+          sendFrame(0xA, payload_, length);
+          dispatch(WStype_PING, payload_, length);
+          break;
+        case 0xA:
+          dispatch(WStype_PONG, payload_, length);
+          break;
+        default:
+          closeSocket();
+          return 0;
+      }
+    }
+    return pos;
+  }
+};
+
+#endif // WEBSOCKETSCLIENT_H
@@ -0,0 +1,107 @@
+/*
+ * VibeMon Host Shim: WiFi
+ * Station that is connected whenever the harness says so (WiFi.hostLinkUp).
+ * The status API listener never accepts a client and scans find nothing:
+ * on the host only the relay connection (WebSocketsClient.h) is real.
+ */
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include "Arduino.h"
+
+class IPAddress : public Printable {
+ public:
+  IPAddress(uint32_t addr = 0) : addr_(addr) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : addr_(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  operator uint32_t() const { return addr_; }
+  uint8_t operator[](int i) const { return (addr_ >> (8 * i)) & 0xFF; }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+  }
+  size_t printTo(Print& p) const override { return p.print(toString()); }
+
+ private:
+  uint32_t addr_;
+};
+
+#define INADDR_NONE IPAddress((uint32_t)0)
+
+typedef enum {
+  WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL, WL_SCAN_COMPLETED, WL_CONNECTED,
+  WL_CONNECT_FAILED, WL_CONNECTION_LOST, WL_DISCONNECTED
+} wl_status_t;
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WIFI_AUTH_OPEN = 0, WIFI_AUTH_WPA2_PSK = 3 } wifi_auth_mode_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+class WiFiClient : public Stream {
+ public:
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(uint8_t*, size_t) { return 0; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t*, size_t n) override { return n; }
+  using Print::write;
+  bool connected() { return false; }
+  void stop() {}
+  operator bool() { return false; }
+  IPAddress remoteIP() const { return IPAddress(); }
+  uint16_t remotePort() const { return 0; }
+  void setNoDelay(bool) {}
+  void setTimeout(unsigned long) {}
+};
+
+class WiFiServer {
+ public:
+  WiFiServer(uint16_t = 80) {}
+  void begin() {}
+  void end() {}
+  void setNoDelay(bool) {}
+  bool hasClient() { return false; }
+  WiFiClient accept() { return WiFiClient(); }
+  WiFiClient available() { return WiFiClient(); }
+};
+
+class WiFiClass {
+ public:
+  bool hostLinkUp = true;  // Associated with the access point (loopback)
+
+  void mode(wifi_mode_t) {}
+  bool softAP(const char*, const char* = nullptr) { return true; }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  wl_status_t begin(const char*, const char* = nullptr, int32_t = 0, const uint8_t* = nullptr, bool = true) {
+    return status();
+  }
+  wl_status_t status() { return hostLinkUp ? WL_CONNECTED : WL_DISCONNECTED; }
+  bool disconnect(bool = false, bool = false) { return true; }
+  bool setAutoReconnect(bool) { return true; }
+  bool setSleep(bool) { return true; }
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress()) { return true; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+  IPAddress dnsIP(int = 0) { return IPAddress(127, 0, 0, 1); }
+  const uint8_t* BSSID() { return bssid_; }
+  int32_t channel() { return 1; }
+  int32_t RSSI() { return -50; }
+  String SSID() { return String("host"); }
+
+  int16_t scanNetworks(bool = false, bool = false) { return 0; }
+  int16_t scanComplete() { return 0; }
+  void scanDelete() {}
+  String SSID(uint8_t) { return String(); }
+  int32_t RSSI(uint8_t) { return 0; }
+  wifi_auth_mode_t encryptionType(uint8_t) { return WIFI_AUTH_OPEN; }
+
+ private:
+  uint8_t bssid_[6] = { 0x02, 0, 0, 0, 0, 0x01 };
+};
+extern WiFiClass WiFi;
+
+#endif // WIFI_H
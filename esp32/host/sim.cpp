@@ -0,0 +1,281 @@
+/*
+ * VibeMon Loop Simulator
+ * Runs the firmware's own setup() and loop() against the virtual clock with
+ * scripted input, and reports wakeups, renders and panel traffic per
+ * simulated hour and per state, for power and performance tuning
+ *
+ * Usage: sim [--hours H] [--seed S] [--json] [--echo] [script.jsonl ...]
+ *
+ * Scripts use the corpus format (replay.h); #gap may span hours. Serial
+ * lines go through loop()'s Serial reader, HTTP/WebSocket lines straight to
+ * processInput() as the transport callbacks would. Without scripts a
+ * synthetic workday is simulated.
+ */
+
+#include <random>
+
+#include "replay.h"
+#include "../esp32.ino"
+
+// =============================================================================
+// Counters
+// =============================================================================
+
+#define SIM_STATES (STATE_ALERT + 1)
+
+// One loop() pass is one wakeup: it runs, then sleeps in delay(getLoopDelay()).
+// A pass is charged to the state it ended in (which chose that delay); it is
+// a render if it wrote anything to the panel.
+struct SimCounters {
+  uint64_t us = 0;
+  uint64_t wakeups = 0;
+  uint64_t renders = 0;
+  uint64_t pixels = 0;
+  uint64_t writes = 0;
+};
+
+struct SimHour {
+  SimCounters states[SIM_STATES];
+  uint64_t messages = 0;
+};
+
+static std::vector<SimHour> simHours;
+
+static void addCounters(SimCounters& total, const SimCounters& c) {
+  total.us += c.us;
+  total.wakeups += c.wakeups;
+  total.renders += c.renders;
+  total.pixels += c.pixels;
+  total.writes += c.writes;
+}
+
+// =============================================================================
+// Synthetic Workday
+// =============================================================================
+
+static std::mt19937 rng(1);
+
+static int pick(int lo, int hi) { return lo + (int)(rng() % (uint32_t)(hi - lo + 1)); }
+
+static void addMessage(ReplayStream& stream, const char* payload, unsigned long gapMs) {
+  stream.messages.push_back({payload, INPUT_SERIAL, 0, gapMs * 1000});
+}
+
+// Coding sessions from 09:00 to 18:00: a prompt, 5-40 minutes of tool use
+// every few seconds, done, then a break of 5-60 minutes. Nights are quiet.
+static ReplayStream syntheticWorkday(int hours) {
+  static const char* const TOOLS[] = { "Bash", "Read", "Edit", "Grep", "Write" };
+  ReplayStream stream{"synthetic/workday", {}};
+  char payload[160];
+  unsigned long at = 0;      // ms of the last message
+  unsigned long next = 0;    // ms of the next message
+  int session = 0;
+
+  for (int day = 0; day * 24 < hours; day++) {
+    unsigned long dayStart = day * 86400000UL;
+    unsigned long workStart = dayStart + 9 * 3600000UL;
+    unsigned long workEnd = dayStart + 18 * 3600000UL;
+    next = std::max(next, workStart);
+
+    while (next < workEnd && next < hours * 3600000UL) {
+      snprintf(payload, sizeof(payload),
+        "{\"state\":\"thinking\",\"project\":\"vibemon\",\"eventId\":\"sim-%d-start\"}", session);
+      addMessage(stream, payload, next - at);
+      at = next;
+
+      unsigned long sessionEnd = at + pick(5, 40) * 60000UL;
+      int step = 0;
+      while (at < sessionEnd) {
+        unsigned long gap = pick(2, 20) * 1000UL;
+        snprintf(payload, sizeof(payload),
+          "{\"state\":\"working\",\"project\":\"vibemon\",\"tool\":\"%s\",\"memory\":%d,\"eventId\":\"sim-%d-%d\"}",
+          TOOLS[pick(0, 4)], pick(10, 90), session, step++);
+        addMessage(stream, payload, gap);
+        at += gap;
+      }
+      snprintf(payload, sizeof(payload),
+        "{\"state\":\"done\",\"project\":\"vibemon\",\"eventId\":\"sim-%d-done\"}", session);
+      addMessage(stream, payload, 1000);
+      at += 1000;
+
+      next = at + pick(5, 60) * 60000UL;
+      session++;
+    }
+  }
+  return stream;
+}
+
+// =============================================================================
+// Simulation
+// =============================================================================
+
+static void deliver(const ReplayMessage& msg) {
+  if (msg.source == INPUT_SERIAL) {
+    Serial.hostInput(msg.payload + "\n");  // Read by the next loop() pass
+  } else {
+    processInput(msg.payload.c_str(), msg.source, msg.sourceId);
+  }
+}
+
+// Run loop() until `hours` of virtual time have passed, delivering each
+// message once its time has come
+static const char* simulate(const ReplayStream& stream, int hours) {
+  resetFirmwareState();
+  hostPanel = HostPanelStats();
+  setup();
+  simHours.assign(hours, SimHour());
+
+  const unsigned long endUs = hours * 3600000000UL;
+  size_t nextMsg = 0;
+  unsigned long dueUs = stream.messages.empty() ? 0 : stream.messages[0].gapUs;
+
+  while (micros() < endUs) {
+    SimHour& hour = simHours[micros() / 3600000000UL];
+    while (nextMsg < stream.messages.size() && dueUs <= micros()) {
+      deliver(stream.messages[nextMsg++]);
+      hour.messages++;
+      if (nextMsg < stream.messages.size()) dueUs += stream.messages[nextMsg].gapUs;
+    }
+
+    unsigned long startUs = micros();
+    uint64_t pixels = hostPanel.pixels;
+    uint64_t writes = hostPanel.writes;
+    loop();
+
+    SimCounters& c = hour.states[currentState];
+    c.us += micros() - startUs;
+    c.wakeups++;
+    if (hostPanel.writes != writes) c.renders++;
+    c.pixels += hostPanel.pixels - pixels;
+    c.writes += hostPanel.writes - writes;
+  }
+  return checkFirmwareInvariants();
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+// Rate per hour spent in the state
+static double perHour(uint64_t value, uint64_t us) {
+  return us > 0 ? value * 3600e6 / us : 0;
+}
+
+static void printTables(const char* name, int hours) {
+  printf("%s: %d simulated hours\n\n", name, hours);
+  printf("%-14s %8s %10s %10s %11s %10s\n", "state", "hours", "wakeups/h", "renders/h", "SPI KB/h", "writes/h");
+
+  SimCounters total;
+  for (int s = 0; s < SIM_STATES; s++) {
+    SimCounters c;
+    for (const SimHour& hour : simHours) addCounters(c, hour.states[s]);
+    addCounters(total, c);
+    if (c.wakeups == 0) continue;
+    printf("%-14s %8.2f %10.0f %10.0f %11.1f %10.0f\n", getStateString((AppState)s), c.us / 3600e6,
+      perHour(c.wakeups, c.us), perHour(c.renders, c.us), perHour(c.pixels * 2, c.us) / 1024,
+      perHour(c.writes, c.us));
+  }
+  printf("%-14s %8.2f %10.0f %10.0f %11.1f %10.0f\n\n", "all", total.us / 3600e6,
+    perHour(total.wakeups, total.us), perHour(total.renders, total.us),
+    perHour(total.pixels * 2, total.us) / 1024, perHour(total.writes, total.us));
+
+  printf("%-5s %6s %9s %9s %10s  %s\n", "hour", "msgs", "wakeups", "renders", "SPI KB", "minutes per state");
+  for (size_t h = 0; h < simHours.size(); h++) {
+    SimCounters c;
+    std::string split;
+    for (int s = 0; s < SIM_STATES; s++) {
+      const SimCounters& sc = simHours[h].states[s];
+      addCounters(c, sc);
+      if (sc.us == 0) continue;
+      char part[32];
+      snprintf(part, sizeof(part), "%s%s %.0f", split.empty() ? "" : ", ",
+        getStateString((AppState)s), sc.us / 60e6);
+      split += part;
+    }
+    printf("%-5zu %6llu %9llu %9llu %10.1f  %s\n", h, (unsigned long long)simHours[h].messages,
+      (unsigned long long)c.wakeups, (unsigned long long)c.renders, c.pixels * 2 / 1024.0, split.c_str());
+  }
+}
+
+// {"hours":[{"messages":n,"states":{"idle":{"ms":..,"wakeups":..,...}}}]}
+static void printJson() {
+  printf("{\"hours\":[");
+  for (size_t h = 0; h < simHours.size(); h++) {
+    printf("%s{\"messages\":%llu,\"states\":{", h > 0 ? "," : "", (unsigned long long)simHours[h].messages);
+    bool first = true;
+    for (int s = 0; s < SIM_STATES; s++) {
+      const SimCounters& c = simHours[h].states[s];
+      if (c.wakeups == 0) continue;
+      printf("%s\"%s\":{\"ms\":%llu,\"wakeups\":%llu,\"renders\":%llu,\"spiBytes\":%llu,\"writes\":%llu}",
+        first ? "" : ",", getStateString((AppState)s), (unsigned long long)(c.us / 1000),
+        (unsigned long long)c.wakeups, (unsigned long long)c.renders,
+        (unsigned long long)(c.pixels * 2), (unsigned long long)c.writes);
+      first = false;
+    }
+    printf("}}");
+  }
+  printf("]}\n");
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+static bool loadScript(const char* path, ReplayStream& stream) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  std::string text;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+  fclose(f);
+  parseReplayText(text.data(), text.size(), stream);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int hours = 0;
+  bool json = false;
+  ReplayStream stream;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--hours") == 0 && i + 1 < argc) {
+      hours = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      rng.seed((uint32_t)strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (strcmp(argv[i], "--echo") == 0) {
+      Serial.echo = true;
+    } else {
+      // Scripts play back to back
+      if (!loadScript(argv[i], stream)) {
+        fprintf(stderr, "{\"error\":\"cannot read %s\"}\n", argv[i]);
+        return 1;
+      }
+      stream.name += stream.name.empty() ? argv[i] : std::string(" + ") + argv[i];
+    }
+  }
+
+  if (stream.name.empty()) {
+    if (hours < 1) hours = 24;
+    stream = syntheticWorkday(hours);
+  } else if (hours < 1) {
+    // Long enough for the script plus the timeouts after its last line
+    unsigned long scriptUs = 0;
+    for (const ReplayMessage& msg : stream.messages) scriptUs += msg.gapUs;
+    hours = (int)((scriptUs + (unsigned long)IDLE_TIMEOUT * 1000 + 2UL * SLEEP_TIMEOUT * 1000) / 3600000000UL) + 1;
+  }
+
+  const char* violation = simulate(stream, hours);
+  if (json) {
+    printJson();
+  } else {
+    printTables(stream.name.c_str(), hours);
+  }
+  if (violation) {
+    fprintf(stderr, "{\"error\":\"invariant violated\",\"invariant\":\"%s\"}\n", violation);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,308 @@
+/*
+ * VibeMon Relay Soak Test
+ * Runs the firmware's own setup() and loop() with WiFi and the relay
+ * WebSocket compiled in, against the local relay stand-in
+ * (tools/ws_relay.py), which injects latency, drops, half-open connections
+ * and auth errors. Reports reconnect times, relay messages lost and heap
+ * drift.
+ *
+ * Usage: soak [--relay HOST:PORT] [--minutes M] [--token T] [--json] [--echo]
+ *
+ * Unlike the other host targets this runs in real time: the relay is a
+ * separate process, so the virtual clock follows the wall clock. Each
+ * loop() pass sleeps for its delay() (socket data waits in the kernel
+ * meanwhile, as it waits in the WiFi stack on the device).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <malloc.h>
+#include <new>
+#include <thread>
+
+// The relay connection from credentials.h, pointed at the stand-in
+#define USE_WIFI
+#define USE_WEBSOCKET
+#define WS_HOST soakRelayHost
+#define WS_PORT soakRelayPort
+#define WS_PATH "/"
+#define WS_USE_SSL false
+
+static char soakRelayHost[64] = "127.0.0.1";
+static uint16_t soakRelayPort = 8765;
+
+#include "TFT_Compat.h"  // The host display (shims/), before esp32.ino picks its own
+#include "../esp32.ino"
+#include "host_firmware.h"
+
+WiFiClass WiFi;
+
+// =============================================================================
+// Heap Accounting
+// =============================================================================
+
+// Bytes live on the host heap (firmware, shims and libc on its behalf). The
+// host figure is not the ESP32 one, but a connection cycle that leaks shows
+// up as drift between samples. On glibc the malloc family is wrapped.
+static int64_t heapLive = 0;
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+extern "C" void __libc_free(void* p);
+
+static void* heapTrack(void* p) {
+  if (p) heapLive += malloc_usable_size(p);
+  return p;
+}
+
+extern "C" void* malloc(size_t size) { return heapTrack(__libc_malloc(size)); }
+extern "C" void* calloc(size_t count, size_t size) { return heapTrack(__libc_calloc(count, size)); }
+extern "C" void* realloc(void* p, size_t size) {
+  if (p) heapLive -= malloc_usable_size(p);
+  return heapTrack(__libc_realloc(p, size));
+}
+extern "C" void free(void* p) {
+  if (p) heapLive -= malloc_usable_size(p);
+  __libc_free(p);
+}
+#endif
+
+void* operator new(size_t size) {
+  void* p = malloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// =============================================================================
+// Relay Observation
+// =============================================================================
+
+// Fixed storage: the harness itself must not move the heap figures
+#define SOAK_MAX_SAMPLES 8192
+
+struct SoakStats {
+  unsigned long disconnectedAt = 0;  // 0: connected, or never connected
+  bool everConnected = false;
+  uint32_t reconnectMs[SOAK_MAX_SAMPLES];
+  uint32_t reconnects = 0;
+  uint32_t longestOutageMs = 0;
+
+  // Relay messages carry "eventId":"soak-N", N counting up from 1 per relay run
+  uint32_t received = 0;
+  uint32_t firstSeq = 0;
+  uint32_t lastSeq = 0;
+  uint32_t gaps = 0;          // Times one or more messages went missing
+  uint32_t outOfOrder = 0;    // Older than the last one (relay restarted?)
+
+  // Baseline once the first relay message has been handled (or after a
+  // minute connected to a quiet relay): allocations made once (first
+  // connection, first message) are not drift
+  int64_t heapBaseline = -1;
+  int64_t heapMin = 0;
+  int64_t heapMax = 0;
+};
+
+static SoakStats soak;
+
+static void observeRelay(WStype_t type, uint8_t* payload, size_t length) {
+  unsigned long now = millis();
+  if (type == WStype_CONNECTED) {
+    if (soak.disconnectedAt != 0) {
+      uint32_t took = now - soak.disconnectedAt;
+      if (soak.reconnects < SOAK_MAX_SAMPLES) soak.reconnectMs[soak.reconnects] = took;
+      soak.reconnects++;
+      soak.longestOutageMs = std::max(soak.longestOutageMs, took);
+    }
+    soak.disconnectedAt = 0;
+    soak.everConnected = true;
+  } else if (type == WStype_DISCONNECTED) {
+    if (soak.everConnected && soak.disconnectedAt == 0) soak.disconnectedAt = now ? now : 1;
+  } else if (type == WStype_TEXT) {
+    const char* id = strstr((const char*)payload, "\"eventId\":\"soak-");
+    if (!id) return;
+    uint32_t seq = strtoul(id + 16, nullptr, 10);
+    (void)length;
+    if (soak.received == 0) {
+      soak.firstSeq = seq;
+    } else if (seq <= soak.lastSeq) {
+      soak.outOfOrder++;
+      return;
+    } else if (seq != soak.lastSeq + 1) {
+      soak.gaps++;
+    }
+    soak.lastSeq = seq;
+    soak.received++;
+  }
+}
+
+static uint32_t lostMessages() {
+  if (soak.received == 0) return 0;
+  return (soak.lastSeq - soak.firstSeq + 1) - soak.received;
+}
+
+// =============================================================================
+// Soak
+// =============================================================================
+
+static std::chrono::steady_clock::time_point wallStart;
+
+static unsigned long wallMicros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - wallStart).count();
+}
+
+// delay() moved the virtual clock ahead: sleep until the wall clock gets
+// there. Slow passes move the virtual clock up to the wall clock instead.
+static void followWallClock() {
+  unsigned long wall = wallMicros();
+  if (micros() > wall) {
+    std::this_thread::sleep_for(std::chrono::microseconds(micros() - wall));
+  } else {
+    hostAdvanceMicros(wall - micros());
+  }
+}
+
+static const char* runSoak(double minutes, const char* token) {
+  // Credentials as provisioned: any SSID (WiFi is the loopback), the token
+  // for the relay URL and the auth message
+  resetSettings(settings);
+  safeCopyStr(settings.wifiSSID, "soak");
+  safeCopyStr(settings.wsToken, token);
+  writeSettings();
+
+  webSocket.hostObserver = observeRelay;
+  wallStart = std::chrono::steady_clock::now();
+  setup();
+
+  const unsigned long endUs = (unsigned long)(minutes * 60e6);
+  unsigned long nextSampleUs = 0;
+  while (micros() < endUs) {
+    loop();
+    followWallClock();
+    if (soak.heapBaseline < 0) {
+      if (soak.received > 0 || (soak.everConnected && micros() >= 60000000UL)) soak.heapBaseline = soak.heapMin = soak.heapMax = heapLive;
+    } else if (micros() >= nextSampleUs) {
+      soak.heapMin = std::min(soak.heapMin, heapLive);
+      soak.heapMax = std::max(soak.heapMax, heapLive);
+      nextSampleUs = micros() + 1000000;
+    }
+  }
+  return checkFirmwareInvariants();
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+static uint32_t percentile(uint32_t* sorted, uint32_t n, int pct) {
+  if (n == 0) return 0;
+  return sorted[std::min(n - 1, (uint32_t)((uint64_t)n * pct / 100))];
+}
+
+static void printReport(double minutes, bool json) {
+  uint32_t n = std::min(soak.reconnects, (uint32_t)SOAK_MAX_SAMPLES);
+  std::sort(soak.reconnectMs, soak.reconnectMs + n);
+  uint32_t p50 = percentile(soak.reconnectMs, n, 50);
+  uint32_t p95 = percentile(soak.reconnectMs, n, 95);
+  uint32_t lost = lostMessages();
+  uint32_t expected = soak.received + lost;
+  int64_t heapEnd = heapLive;
+  int64_t drift = soak.heapBaseline >= 0 ? heapEnd - soak.heapBaseline : 0;
+  const HostWsStats& ws = webSocket.hostStats;
+  uint32_t reinits = ws.begins > 0 ? ws.begins - 1 : 0;
+
+  if (json) {
+    printf("{\"minutes\":%.1f,\"relay\":\"%s:%u\",", minutes, soakRelayHost, soakRelayPort);
+    printf("\"connections\":{\"connects\":%lu,\"disconnects\":%lu,\"handshakeFailures\":%lu,"
+      "\"connectFailures\":%lu,\"reinits\":%lu,\"heartbeatDrops\":%lu},",
+      (unsigned long)ws.connects, (unsigned long)ws.disconnects, (unsigned long)ws.handshakeFailures,
+      (unsigned long)ws.tcpFailures, (unsigned long)reinits, (unsigned long)wsHealth.heartbeatDrops);
+    printf("\"reconnectMs\":{\"count\":%lu,\"p50\":%lu,\"p95\":%lu,\"max\":%lu},",
+      (unsigned long)soak.reconnects, (unsigned long)p50, (unsigned long)p95,
+      (unsigned long)soak.longestOutageMs);
+    printf("\"messages\":{\"received\":%lu,\"lost\":%lu,\"gaps\":%lu,\"outOfOrder\":%lu},",
+      (unsigned long)soak.received, (unsigned long)lost, (unsigned long)soak.gaps,
+      (unsigned long)soak.outOfOrder);
+    printf("\"heap\":{\"baseline\":%lld,\"end\":%lld,\"drift\":%lld,\"min\":%lld,\"max\":%lld},",
+      (long long)soak.heapBaseline, (long long)heapEnd, (long long)drift,
+      (long long)soak.heapMin, (long long)soak.heapMax);
+    char health[512];
+    writeWsHealthJson(health, sizeof(health));
+    printf("\"websocket\":%s}\n", health);
+    return;
+  }
+
+  printf("soak: %.1f minutes against %s:%u\n\n", minutes, soakRelayHost, soakRelayPort);
+  printf("%-14s %lu connects, %lu disconnects, %lu handshake failures, %lu connect failures\n",
+    "connections", (unsigned long)ws.connects, (unsigned long)ws.disconnects,
+    (unsigned long)ws.handshakeFailures, (unsigned long)ws.tcpFailures);
+  printf("%-14s %lu heartbeat drops, %lu forced re-inits\n", "",
+    (unsigned long)wsHealth.heartbeatDrops, (unsigned long)reinits);
+  printf("%-14s %lu reconnects, p50 %lu ms, p95 %lu ms, max %lu ms\n", "reconnect",
+    (unsigned long)soak.reconnects, (unsigned long)p50, (unsigned long)p95,
+    (unsigned long)soak.longestOutageMs);
+  printf("%-14s %lu received, %lu lost (%.1f%%) in %lu gaps, %lu out of order\n", "relay msgs",
+    (unsigned long)soak.received, (unsigned long)lost, expected > 0 ? lost * 100.0 / expected : 0,
+    (unsigned long)soak.gaps, (unsigned long)soak.outOfOrder);
+  printf("%-14s baseline %lld B, end %lld B, drift %+lld B (min %lld, max %lld)\n", "heap",
+    (long long)soak.heapBaseline, (long long)heapEnd, (long long)drift,
+    (long long)soak.heapMin, (long long)soak.heapMax);
+  printf("%-14s srtt %lu ms, rto %lu ms, ping after %lu ms idle, %lu/%lu pongs\n", "heartbeat",
+    (unsigned long)wsHealth.srtt, (unsigned long)wsHealth.rto, (unsigned long)getWsPingIdle(),
+    (unsigned long)wsHealth.pongs, (unsigned long)wsHealth.pings);
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+int main(int argc, char** argv) {
+  double minutes = 10;
+  bool json = false;
+  const char* token = "";
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--relay") == 0 && i + 1 < argc) {
+      const char* relay = argv[++i];
+      const char* colon = strrchr(relay, ':');
+      if (!colon || colon == relay || (size_t)(colon - relay) >= sizeof(soakRelayHost)) {
+        fprintf(stderr, "{\"error\":\"--relay expects HOST:PORT\"}\n");
+        return 1;
+      }
+      snprintf(soakRelayHost, sizeof(soakRelayHost), "%.*s", (int)(colon - relay), relay);
+      soakRelayPort = (uint16_t)atoi(colon + 1);
+    } else if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc) {
+      minutes = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--token") == 0 && i + 1 < argc) {
+      token = argv[++i];
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (strcmp(argv[i], "--echo") == 0) {
+      Serial.echo = true;
+    } else {
+      fprintf(stderr, "Usage: soak [--relay HOST:PORT] [--minutes M] [--token T] [--json] [--echo]\n");
+      return 1;
+    }
+  }
+  if (minutes <= 0) minutes = 10;
+
+  const char* violation = runSoak(minutes, token);
+  printReport(minutes, json);
+  if (violation) {
+    fprintf(stderr, "{\"error\":\"invariant violated\",\"invariant\":\"%s\"}\n", violation);
+    return 1;
+  }
+  if (!soak.everConnected) {
+    fprintf(stderr, "{\"error\":\"never connected to the relay\",\"relay\":\"%s:%u\"}\n",
+      soakRelayHost, soakRelayPort);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,627 @@
+/*
+ * VibeMon HTTP Server
+ * Non-blocking HTTP/1.1 server for the status API: several connections at
+ * once, each parsed incrementally into preallocated buffers (no String) and
+ * polled from loop(). Connections are persistent (keep-alive) and requests
+ * may be pipelined. Status watchers (long poll, event stream) are parked
+ * until the status snapshot changes. The provisioning portal keeps using
+ * WebServer.
+ */
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#ifdef USE_WIFI
+
+#define HTTP_PATH_SIZE 32    // Longer paths match no route (404)
+#define HTTP_QUERY_SIZE 48   // Longer query strings keep the complete parameters that fit
+#define HTTP_LINE_SIZE 128   // Request/header line (longer header lines are truncated;
+                             // a longer request line keeps its start and its end)
+#define HTTP_LINE_TAIL 12    // End of an overlong request line kept (" HTTP/1.1")
+#define HTTP_RX_SIZE   128   // Bytes read from the socket at a time
+
+// =============================================================================
+// Connections
+// =============================================================================
+
+enum HttpConnState : uint8_t {
+  HTTP_CONN_FREE,          // Slot unused
+  HTTP_CONN_REQUEST_LINE,  // Waiting for "METHOD /path HTTP/1.1" (idle if nothing received)
+  HTTP_CONN_HEADERS,
+  HTTP_CONN_BODY,
+  HTTP_CONN_DISCARD,       // Body too large: read and dropped before the 413
+  HTTP_CONN_READY,         // Request complete (or rejected: error != 0)
+  HTTP_CONN_WAITING,       // Long poll parked until the status changes
+  HTTP_CONN_STREAM         // Event stream: open until the client leaves
+};
+
+struct HttpConnection {
+  WiFiClient client;
+  HttpConnState state;
+  uint32_t remoteIP;
+  unsigned long lastActivity;  // millis() of the last byte received or response sent
+  uint16_t requests;           // Served on this connection
+  HTTPMethod method;
+  int error;                   // Status to reject the request with (0 = none)
+  bool expectContinue;
+  bool keepAlive;              // Keep the connection open after the response
+  bool writeFailed;            // A write timed out: closed when the response is done
+  char path[HTTP_PATH_SIZE];
+  char query[HTTP_QUERY_SIZE]; // Without the '?'
+  uint32_t lastEventId;        // Last-Event-ID header (event stream reconnect)
+  uint32_t watchSeq;           // Watchers: statusSeq the client has seen
+  unsigned long watchStart;    // Long poll: parked at (millis)
+  unsigned long watchMs;       // Long poll: answer unchanged after this long
+  char line[HTTP_LINE_SIZE];
+  uint16_t lineLen;
+  bool lineCut;                // Request line overflowed (see keepHttpLineTail())
+  uint8_t rx[HTTP_RX_SIZE];    // Received, not yet parsed
+  uint8_t rxPos;
+  uint8_t rxLen;
+  size_t contentLength;
+  size_t bodyLen;              // Body bytes received (discarded ones too)
+  unsigned long discardStart;  // Discarding since (millis)
+  char body[HTTP_BODY_SIZE];   // NUL-terminated
+};
+
+typedef void (*HttpHandler)();
+
+struct HttpRoute {
+  const char* path;
+  HTTPMethod method;
+  HttpHandler handler;
+};
+
+WiFiServer httpListener(80);
+HttpConnection httpConnections[HTTP_MAX_CONNECTIONS];
+const HttpRoute* httpRoutes = nullptr;
+size_t httpRouteCount = 0;
+
+// Connection whose request is being handled (handlers respond through it)
+HttpConnection* httpCurrent = nullptr;
+
+void resetHttpRequest(HttpConnection& conn) {
+  conn.state = HTTP_CONN_REQUEST_LINE;
+  conn.error = 0;
+  conn.expectContinue = false;
+  conn.keepAlive = false;
+  conn.path[0] = '\0';
+  conn.query[0] = '\0';
+  conn.lastEventId = 0;
+  conn.lineLen = 0;
+  conn.lineCut = false;
+  conn.contentLength = 0;
+  conn.bodyLen = 0;
+  conn.body[0] = '\0';
+}
+
+void closeHttpConnection(HttpConnection& conn) {
+  conn.client.stop();
+  conn.state = HTTP_CONN_FREE;
+}
+
+// Every write goes through here. It blocks loop() until lwIP takes the
+// data, for at most HTTP_WRITE_TIMEOUT_MS (set on accept). A short write
+// means the client stopped reading: the rest of the response is skipped
+// and the connection closed.
+bool writeHttpClient(HttpConnection& conn, const uint8_t* data, size_t len) {
+  if (conn.writeFailed) return false;
+  if (conn.client.write(data, len) == len) return true;
+  conn.writeFailed = true;
+  conn.keepAlive = false;
+  return false;
+}
+
+// Long poll or event stream (serviced by serviceHttpWatchers())
+bool isHttpWatcher(const HttpConnection& conn) {
+  return conn.state == HTTP_CONN_WAITING || conn.state == HTTP_CONN_STREAM;
+}
+
+// Between requests with nothing received: may be closed to free the slot
+bool isHttpConnectionIdle(const HttpConnection& conn) {
+  return conn.state == HTTP_CONN_REQUEST_LINE && conn.lineLen == 0 && conn.rxPos == conn.rxLen;
+}
+
+// =============================================================================
+// Request Parsing
+// =============================================================================
+
+HTTPMethod parseHttpMethod(const char* method, size_t len) {
+  if (len == 3 && strncmp(method, "GET", 3) == 0) return HTTP_GET;
+  if (len == 4 && strncmp(method, "POST", 4) == 0) return HTTP_POST;
+  if (len == 6 && strncmp(method, "DELETE", 6) == 0) return HTTP_DELETE;
+  if (len == 3 && strncmp(method, "PUT", 3) == 0) return HTTP_PUT;
+  if (len == 4 && strncmp(method, "HEAD", 4) == 0) return HTTP_HEAD;
+  return HTTP_ANY;  // Matches no route
+}
+
+// Request line longer than the buffer: keep its start (method, path, the
+// query as far as it fits) and a window with its last bytes, so the version
+// at the end still parses. A space marks the cut: the query ends there.
+void keepHttpLineTail(HttpConnection& conn, char c) {
+  char* tail = conn.line + sizeof(conn.line) - 1 - HTTP_LINE_TAIL;
+  if (!conn.lineCut) {
+    tail[-1] = ' ';
+    conn.lineCut = true;
+  }
+  memmove(tail, tail + 1, HTTP_LINE_TAIL - 1);
+  tail[HTTP_LINE_TAIL - 1] = c;
+}
+
+// Query string up to the first space. If it was cut (too long for the
+// buffer or the request line), the parameter the cut fell in is dropped.
+void copyHttpQuery(HttpConnection& conn, const char* query) {
+  size_t queryLen = strcspn(query, " ");
+  bool cut = conn.lineCut;
+  if (queryLen >= sizeof(conn.query)) {
+    queryLen = sizeof(conn.query) - 1;
+    cut = query[queryLen] != '&';
+  }
+  if (cut) {
+    while (queryLen > 0 && query[queryLen] != '&') queryLen--;
+  }
+  memcpy(conn.query, query, queryLen);
+  conn.query[queryLen] = '\0';
+}
+
+// "METHOD /path[?query] HTTP/1.x". HTTP/1.1 connections persist by default.
+bool parseHttpRequestLine(HttpConnection& conn) {
+  const char* line = conn.line;
+  const char* space = strchr(line, ' ');
+  if (!space || space == line) return false;
+  conn.method = parseHttpMethod(line, space - line);
+
+  const char* path = space + 1;
+  size_t pathLen = strcspn(path, " ?");
+  if (pathLen == 0 || path[0] != '/') return false;
+  const char* query = path[pathLen] == '?' ? path + pathLen + 1 : nullptr;
+  if (pathLen >= sizeof(conn.path)) pathLen = sizeof(conn.path) - 1;
+  memcpy(conn.path, path, pathLen);
+  conn.path[pathLen] = '\0';
+  if (query) copyHttpQuery(conn, query);
+  const char* version = strstr(path, " HTTP/1.");
+  if (!version) return false;
+  conn.keepAlive = version[8] != '0';
+  return true;
+}
+
+// Header names are case-insensitive; values start after optional spaces
+const char* getHttpHeaderValue(const char* line, const char* name) {
+  size_t len = strlen(name);
+  if (strncasecmp(line, name, len) != 0 || line[len] != ':') return nullptr;
+  const char* value = line + len + 1;
+  while (*value == ' ' || *value == '\t') value++;
+  return value;
+}
+
+void parseHttpHeader(HttpConnection& conn) {
+  const char* value;
+  if ((value = getHttpHeaderValue(conn.line, "Content-Length"))) {
+    conn.contentLength = strtoul(value, nullptr, 10);
+  } else if ((value = getHttpHeaderValue(conn.line, "Transfer-Encoding"))) {
+    if (strncasecmp(value, "identity", 8) != 0) conn.error = 411;  // Chunked bodies: send a length
+  } else if ((value = getHttpHeaderValue(conn.line, "Connection"))) {
+    if (strncasecmp(value, "close", 5) == 0) conn.keepAlive = false;
+    if (strncasecmp(value, "keep-alive", 10) == 0) conn.keepAlive = true;
+  } else if ((value = getHttpHeaderValue(conn.line, "Expect"))) {
+    conn.expectContinue = strncasecmp(value, "100-continue", 12) == 0;
+  } else if ((value = getHttpHeaderValue(conn.line, "Last-Event-ID"))) {
+    conn.lastEventId = strtoul(value, nullptr, 10);
+  }
+}
+
+// Headers done: decide whether a body follows. A body too large is read
+// and dropped first (at most HTTP_REQUEST_TIMEOUT_MS): closing with unread
+// data makes lwIP reset the connection, and the client would see that
+// instead of the 413. Not when the client waits for 100 Continue.
+void finishHttpHeaders(HttpConnection& conn) {
+  if (conn.error == 0 && conn.contentLength >= sizeof(conn.body)) {
+    conn.error = 413;
+    if (!conn.expectContinue) {
+      conn.state = HTTP_CONN_DISCARD;
+      conn.discardStart = millis();
+      return;
+    }
+  }
+  if (conn.error != 0 || conn.contentLength == 0) {
+    conn.state = HTTP_CONN_READY;
+    return;
+  }
+  if (conn.expectContinue) {
+    static const char interim[] = "HTTP/1.1 100 Continue\r\n\r\n";
+    writeHttpClient(conn, (const uint8_t*)interim, sizeof(interim) - 1);
+  }
+  conn.state = HTTP_CONN_BODY;
+}
+
+// Consume received bytes until the request is complete. Returns the number
+// of bytes used; the rest belongs to whatever the client sends next.
+size_t feedHttpConnection(HttpConnection& conn, const uint8_t* data, size_t len) {
+  size_t used = 0;
+  while (used < len && conn.state != HTTP_CONN_READY) {
+    if (conn.state == HTTP_CONN_BODY) {
+      size_t n = min(len - used, conn.contentLength - conn.bodyLen);
+      memcpy(conn.body + conn.bodyLen, data + used, n);
+      conn.bodyLen += n;
+      used += n;
+      if (conn.bodyLen == conn.contentLength) {
+        conn.body[conn.bodyLen] = '\0';
+        conn.state = HTTP_CONN_READY;
+      }
+      continue;
+    }
+    if (conn.state == HTTP_CONN_DISCARD) {
+      size_t n = min(len - used, conn.contentLength - conn.bodyLen);
+      conn.bodyLen += n;
+      used += n;
+      if (conn.bodyLen == conn.contentLength) conn.state = HTTP_CONN_READY;
+      continue;
+    }
+
+    char c = (char)data[used++];
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (conn.lineLen < sizeof(conn.line) - 1) {
+        conn.line[conn.lineLen++] = c;
+      } else if (conn.state == HTTP_CONN_REQUEST_LINE) {
+        keepHttpLineTail(conn, c);
+      }
+      continue;
+    }
+    conn.line[conn.lineLen] = '\0';
+    if (conn.state == HTTP_CONN_REQUEST_LINE) {
+      if (conn.lineLen == 0) continue;  // Stray CRLF between requests
+      if (!parseHttpRequestLine(conn)) {
+        conn.error = 400;
+        conn.state = HTTP_CONN_READY;
+      } else {
+        conn.state = HTTP_CONN_HEADERS;
+      }
+    } else if (conn.lineLen == 0) {
+      finishHttpHeaders(conn);
+    } else {
+      parseHttpHeader(conn);
+    }
+    conn.lineLen = 0;
+    conn.lineCut = false;
+  }
+  return used;
+}
+
+// =============================================================================
+// Responses
+// =============================================================================
+
+const char* getHttpStatusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 411: return "Length Required";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 503: return "Service Unavailable";
+    default: return "Error";
+  }
+}
+
+// Status line and headers. length < 0: chunked body follows.
+int formatHttpHead(char* buf, size_t size, const HttpConnection& conn, int code, const char* type, long length) {
+  char framing[40];
+  if (length < 0) {
+    safeCopyStr(framing, "Transfer-Encoding: chunked");
+  } else {
+    snprintf(framing, sizeof(framing), "Content-Length: %ld", length);
+  }
+  if (conn.keepAlive) {
+    return snprintf(buf, size,
+      "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n%s\r\nConnection: keep-alive\r\nKeep-Alive: timeout=%d\r\n\r\n",
+      code, getHttpStatusText(code), type, framing, HTTP_KEEPALIVE_TIMEOUT_MS / 1000);
+  }
+  return snprintf(buf, size, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n%s\r\nConnection: close\r\n\r\n",
+    code, getHttpStatusText(code), type, framing);
+}
+
+// Full response to the current request, in one write when it fits
+void httpSend(int code, const char* type, const char* body) {
+  if (!httpCurrent) return;
+  HttpConnection& conn = *httpCurrent;
+  char buf[512];
+  size_t bodyLen = strlen(body);
+  int headLen = formatHttpHead(buf, sizeof(buf), *httpCurrent, code, type, (long)bodyLen);
+  if ((size_t)headLen + bodyLen < sizeof(buf)) {
+    memcpy(buf + headLen, body, bodyLen);
+    writeHttpClient(conn, (const uint8_t*)buf, headLen + bodyLen);
+  } else if (writeHttpClient(conn, (const uint8_t*)buf, headLen)) {
+    writeHttpClient(conn, (const uint8_t*)body, bodyLen);
+  }
+}
+
+// Response of known length written in pieces with httpWrite()
+void httpBeginResponse(int code, const char* type, size_t length) {
+  if (!httpCurrent) return;
+  char head[160];
+  int headLen = formatHttpHead(head, sizeof(head), *httpCurrent, code, type, (long)length);
+  writeHttpClient(*httpCurrent, (const uint8_t*)head, headLen);
+}
+
+void httpWrite(const uint8_t* data, size_t len) {
+  if (httpCurrent) writeHttpClient(*httpCurrent, data, len);
+}
+
+// Chunked response: httpBeginChunked(), httpSendChunk()..., httpEndChunked()
+void httpBeginChunked(int code, const char* type) {
+  if (!httpCurrent) return;
+  char head[160];
+  int headLen = formatHttpHead(head, sizeof(head), *httpCurrent, code, type, -1);
+  writeHttpClient(*httpCurrent, (const uint8_t*)head, headLen);
+}
+
+void httpSendChunk(const char* data, size_t len) {
+  if (!httpCurrent || len == 0) return;
+  char size[12];
+  int n = snprintf(size, sizeof(size), "%x\r\n", (unsigned)len);
+  writeHttpClient(*httpCurrent, (const uint8_t*)size, n);
+  writeHttpClient(*httpCurrent, (const uint8_t*)data, len);
+  writeHttpClient(*httpCurrent, (const uint8_t*)"\r\n", 2);
+}
+
+void httpEndChunked() {
+  if (httpCurrent) writeHttpClient(*httpCurrent, (const uint8_t*)"0\r\n\r\n", 5);
+}
+
+// Request accessors for handlers
+bool httpHasBody() { return httpCurrent && httpCurrent->bodyLen > 0; }
+const char* httpBody() { return httpCurrent ? httpCurrent->body : ""; }
+uint32_t httpRemoteIP() { return httpCurrent ? httpCurrent->remoteIP : 0; }
+uint32_t httpLastEventId() { return httpCurrent ? httpCurrent->lastEventId : 0; }
+
+// Integer query parameter ("/status?wait=5000&since=3"), def if absent
+long httpQueryParam(const char* name, long def) {
+  if (!httpCurrent) return def;
+  size_t len = strlen(name);
+  for (const char* p = httpCurrent->query; *p; ) {
+    if (strncmp(p, name, len) == 0 && p[len] == '=') return strtol(p + len + 1, nullptr, 10);
+    p += strcspn(p, "&");
+    if (*p == '&') p++;
+  }
+  return def;
+}
+
+// =============================================================================
+// Dispatch & Polling
+// =============================================================================
+
+void finishHttpRequest(HttpConnection& conn);
+
+// Answer a complete request. The connection stays open for the next one
+// unless the client asked to close, the request could not be read in full
+// (error), or the connection has served its quota.
+void dispatchHttpRequest(HttpConnection& conn) {
+  conn.requests++;
+  if (conn.error != 0 || conn.requests >= HTTP_KEEPALIVE_MAX_REQUESTS) conn.keepAlive = false;
+
+  httpCurrent = &conn;
+  if (conn.error != 0) {
+    char response[64];
+    snprintf(response, sizeof(response), "{\"error\":\"%s\"}", getHttpStatusText(conn.error));
+    httpSend(conn.error, "application/json", response);
+  } else {
+    bool pathFound = false;
+    HttpHandler handler = nullptr;
+    for (size_t i = 0; i < httpRouteCount && !handler; i++) {
+      if (strcmp(httpRoutes[i].path, conn.path) != 0) continue;
+      pathFound = true;
+      if (httpRoutes[i].method == conn.method) handler = httpRoutes[i].handler;
+    }
+    if (handler) {
+      handler();
+    } else if (pathFound) {
+      httpSend(405, "application/json", "{\"error\":\"Method Not Allowed\"}");
+    } else {
+      httpSend(404, "application/json", "{\"error\":\"Not Found\"}");
+    }
+  }
+  httpCurrent = nullptr;
+
+  // Parked by the handler: answered later by serviceHttpWatchers()
+  if (isHttpWatcher(conn)) return;
+  finishHttpRequest(conn);
+}
+
+// Response sent: on to the next request, or close
+void finishHttpRequest(HttpConnection& conn) {
+  if (conn.keepAlive) {
+    resetHttpRequest(conn);
+    conn.lastActivity = millis();
+  } else {
+    closeHttpConnection(conn);
+  }
+}
+
+// Read what has arrived and answer every request completed by it
+// (pipelined requests are answered in order)
+void serviceHttpConnection(HttpConnection& conn) {
+  // Watchers are serviced by serviceHttpWatchers(); requests pipelined
+  // behind a long poll are read once it is answered
+  if (isHttpWatcher(conn)) return;
+
+  while (conn.state != HTTP_CONN_FREE && !isHttpWatcher(conn)) {
+    if (conn.rxPos == conn.rxLen) {
+      int available = conn.client.available();
+      if (available <= 0) break;
+      int n = conn.client.read(conn.rx, min(available, (int)sizeof(conn.rx)));
+      if (n <= 0) break;
+      conn.rxPos = 0;
+      conn.rxLen = n;
+      conn.lastActivity = millis();
+    }
+    conn.rxPos += feedHttpConnection(conn, conn.rx + conn.rxPos, conn.rxLen - conn.rxPos);
+    if (conn.state == HTTP_CONN_READY) dispatchHttpRequest(conn);
+  }
+  if (conn.state == HTTP_CONN_FREE || isHttpWatcher(conn)) return;
+
+  unsigned long idleMs = millis() - conn.lastActivity;
+  if (!conn.client.connected()) {
+    closeHttpConnection(conn);
+  } else if (isHttpConnectionIdle(conn)) {
+    if (idleMs >= HTTP_KEEPALIVE_TIMEOUT_MS) closeHttpConnection(conn);
+  } else if (conn.state == HTTP_CONN_DISCARD) {
+    if (millis() - conn.discardStart >= HTTP_REQUEST_TIMEOUT_MS) dispatchHttpRequest(conn);  // 413 anyway
+  } else if (idleMs >= HTTP_REQUEST_TIMEOUT_MS) {
+    conn.error = 408;
+    dispatchHttpRequest(conn);
+  }
+}
+
+// Longest-idle persistent connection, or nullptr if every slot is mid-request
+HttpConnection* findIdleHttpConnection() {
+  HttpConnection* oldest = nullptr;
+  for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& conn = httpConnections[i];
+    if (!isHttpConnectionIdle(conn)) continue;
+    if (!oldest || millis() - conn.lastActivity > millis() - oldest->lastActivity) oldest = &conn;
+  }
+  return oldest;
+}
+
+// Called from loop(): accept into free slots, then service every open
+// connection. Reads never block; a write to a client that stopped reading
+// holds loop() up for at most HTTP_WRITE_TIMEOUT_MS, then the connection is
+// dropped. With all slots taken, a waiting client takes over the
+// longest-idle persistent connection; otherwise it stays in the TCP backlog.
+void pollHttpServer() {
+  for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& conn = httpConnections[i];
+    if (conn.state != HTTP_CONN_FREE) continue;
+    WiFiClient client = httpListener.accept();
+    if (!client) break;
+    conn.client = client;
+    conn.client.setTimeout(HTTP_WRITE_TIMEOUT_MS);  // Bounds blocking writes (writeHttpClient())
+    conn.writeFailed = false;
+    conn.remoteIP = (uint32_t)client.remoteIP();
+    conn.lastActivity = millis();
+    conn.requests = 0;
+    conn.rxPos = conn.rxLen = 0;
+    resetHttpRequest(conn);
+  }
+
+  for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    if (httpConnections[i].state != HTTP_CONN_FREE) serviceHttpConnection(httpConnections[i]);
+  }
+
+  if (httpListener.hasClient()) {
+    HttpConnection* idle = findIdleHttpConnection();
+    if (idle) closeHttpConnection(*idle);  // Slot reused on the next poll
+  }
+}
+
+// =============================================================================
+// Status Watchers
+// =============================================================================
+
+// Long polls (GET /status?wait=) and event streams (GET /events) wait for
+// the status snapshot (status_watch.h) to change without holding a handler
+// or loop() up. At most HTTP_MAX_WATCHERS at once, so slots remain for
+// ordinary requests.
+
+int countHttpWatchers() {
+  int count = 0;
+  for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    if (isHttpWatcher(httpConnections[i])) count++;
+  }
+  return count;
+}
+
+// Answer the current request with the snapshot: {"seq":N,...}
+void httpSendStatusEvent() {
+  char body[STATUS_EVENT_SIZE + 24];
+  snprintf(body, sizeof(body), "{\"seq\":%lu,%s}", (unsigned long)statusSeq, statusEvent);
+  httpSend(200, "application/json", body);
+}
+
+bool httpWatcherSlotAvailable() {
+  if (countHttpWatchers() < HTTP_MAX_WATCHERS) return true;
+  httpSend(503, "application/json", "{\"error\":\"Too many watchers\"}");
+  return false;
+}
+
+// Park the current request until statusSeq moves past `since`, or waitMs
+// have passed (then answered with the unchanged snapshot)
+void httpWaitForStatus(uint32_t since, unsigned long waitMs) {
+  if (!httpCurrent || !httpWatcherSlotAvailable()) return;
+  httpCurrent->state = HTTP_CONN_WAITING;
+  httpCurrent->watchSeq = since;
+  httpCurrent->watchStart = millis();
+  httpCurrent->watchMs = waitMs;
+}
+
+void writeHttpStatusEvent(HttpConnection& conn) {
+  char event[STATUS_EVENT_SIZE + 48];
+  int len = snprintf(event, sizeof(event), "id: %lu\ndata: {\"seq\":%lu,%s}\n\n",
+    (unsigned long)statusSeq, (unsigned long)statusSeq, statusEvent);
+  writeHttpClient(conn, (const uint8_t*)event, min(len, (int)sizeof(event) - 1));
+  conn.watchSeq = statusSeq;
+  conn.lastActivity = millis();
+}
+
+// Turn the current request into a Server-Sent Events stream. The snapshot
+// is sent first unless the client already has it (lastId, on reconnect).
+void httpBeginEventStream(uint32_t lastId) {
+  if (!httpCurrent || !httpWatcherSlotAvailable()) return;
+  static const char head[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+    "Connection: close\r\n\r\nretry: 3000\n\n";
+  HttpConnection& conn = *httpCurrent;
+  writeHttpClient(conn, (const uint8_t*)head, sizeof(head) - 1);
+  conn.state = HTTP_CONN_STREAM;
+  conn.keepAlive = false;
+  refreshStatusEvent();
+  if (lastId == statusSeq) {
+    conn.watchSeq = statusSeq;
+    conn.lastActivity = millis();
+  } else {
+    writeHttpStatusEvent(conn);
+  }
+}
+
+// Called from loop() once queued updates are applied and drawn: answer
+// long polls whose status changed or timed out, push changes to event
+// streams, and keep idle streams alive with a comment line
+void serviceHttpWatchers() {
+  if (countHttpWatchers() == 0) return;
+  refreshStatusEvent();
+  unsigned long now = millis();
+
+  for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& conn = httpConnections[i];
+    if (!isHttpWatcher(conn)) continue;
+    if (!conn.client.connected() || conn.writeFailed) {
+      closeHttpConnection(conn);  // Left, or stopped reading (a stalled watcher never holds loop() up twice)
+    } else if (conn.state == HTTP_CONN_WAITING) {
+      if (conn.watchSeq != statusSeq || now - conn.watchStart >= conn.watchMs) {
+        httpCurrent = &conn;
+        httpSendStatusEvent();
+        httpCurrent = nullptr;
+        finishHttpRequest(conn);
+      }
+    } else if (conn.watchSeq != statusSeq) {
+      writeHttpStatusEvent(conn);
+    } else if (now - conn.lastActivity >= HTTP_SSE_PING_MS) {
+      writeHttpClient(conn, (const uint8_t*)":\n\n", 3);
+      conn.lastActivity = now;
+    }
+  }
+}
+
+void beginHttpServer(const HttpRoute* routes, size_t count) {
+  httpRoutes = routes;
+  httpRouteCount = count;
+  httpListener.setNoDelay(true);  // Responses are small: don't wait for ACKs (Nagle)
+  httpListener.begin();
+}
+
+#endif // USE_WIFI
+#endif // HTTP_SERVER_H
@@ -10,49 +10,179 @@
 // Status JSON Builder
 // =============================================================================
 
-// Build status JSON into buffer (shared by Serial command handler and HTTP handler)
+// Build status JSON into buffer (shared by Serial command handler and HTTP
+// handler). Project names are escaped: size STATUS_JSON_SIZE.
 void buildStatusJson(char* buf, size_t size) {
-  if (strlen(lockedProject) > 0) {
-    snprintf(buf, size,
-      "{\"state\":\"%s\",\"project\":\"%s\",\"lockedProject\":\"%s\",\"lockMode\":\"%s\",\"projectCount\":%d}",
-      getStateString(currentState), currentProject, lockedProject, getLockModeString(), projectCount);
+  JsonWriter json;
+  jsonBegin(json, buf, size - 1);  // Room for the NUL
+  jsonBeginObject(json);
+  jsonKey(json, "state");
+  jsonString(json, getStateString(currentState));
+  jsonKey(json, "project");
+  jsonString(json, currentProject);
+  jsonKey(json, "lockedProject");
+  if (lockedProjectId != PROJECT_NONE) {
+    jsonString(json, getLockedProject());
   } else {
-    snprintf(buf, size,
-      "{\"state\":\"%s\",\"project\":\"%s\",\"lockedProject\":null,\"lockMode\":\"%s\",\"projectCount\":%d}",
-      getStateString(currentState), currentProject, getLockModeString(), projectCount);
+    jsonNull(json);
   }
+  jsonKey(json, "lockMode");
+  jsonString(json, getLockModeString());
+  jsonKey(json, "projectCount");
+  jsonInt(json, projectCount);
+  jsonEndObject(json);
+  buf[json.len] = '\0';
+}
+
+// Build input pipeline metrics JSON into buffer (Serial "metrics" command and GET /metrics)
+void buildMetricsJson(char* buf, size_t size) {
+  size_t len = snprintf(buf, size,
+    "{\"dedup\":{\"serial\":%lu,\"http\":%lu,\"websocket\":%lu,\"udp\":%lu,\"websocket-lan\":%lu},"
+    "\"lanes\":{\"control\":{\"count\":%lu,\"avgUs\":%lu,\"maxUs\":%lu},"
+    "\"status\":{\"count\":%lu,\"avgUs\":%lu,\"maxUs\":%lu,\"coalesced\":%lu,\"dropped\":%lu,\"queued\":%d}},"
+    "\"admission\":{",
+    (unsigned long)dedupSuppressed[INPUT_SERIAL],
+    (unsigned long)dedupSuppressed[INPUT_HTTP],
+    (unsigned long)dedupSuppressed[INPUT_WEBSOCKET],
+    (unsigned long)dedupSuppressed[INPUT_UDP],
+    (unsigned long)dedupSuppressed[INPUT_WEBSOCKET_LAN],
+    (unsigned long)laneStats[LANE_CONTROL].count,
+    (unsigned long)getLaneAvgUs(LANE_CONTROL),
+    (unsigned long)laneStats[LANE_CONTROL].maxUs,
+    (unsigned long)laneStats[LANE_STATUS].count,
+    (unsigned long)getLaneAvgUs(LANE_STATUS),
+    (unsigned long)laneStats[LANE_STATUS].maxUs,
+    (unsigned long)statusCoalesced,
+    (unsigned long)statusDropped,
+    statusQueueLen);
+  for (int i = 0; i < INPUT_SOURCE_COUNT && len < size; i++) {
+    len += snprintf(buf + len, size - len, "%s\"%s\":{\"admitted\":%lu,\"coalesced\":%lu,\"dropped\":%lu}",
+      i > 0 ? "," : "", getInputSourceString((InputSource)i),
+      (unsigned long)rateAdmitted[i], (unsigned long)rateCoalesced[i], (unsigned long)rateDropped[i]);
+  }
+  if (len < size) {
+    len += snprintf(buf + len, size - len, "},\"rotation\":{\"switches\":%lu,\"precomposed\":%lu}",
+      (unsigned long)rotationSwitches, (unsigned long)rotationPrecomposed);
+  }
+#ifdef USE_WIFI
+  if (len < size) {
+    len += snprintf(buf + len, size - len, ",\"wifi\":{\"connectMs\":%lu,\"fastConnect\":%s}",
+      (unsigned long)wifiConnectMs, wifiFastConnect ? "true" : "false");
+  }
+#ifdef USE_WEBSOCKET
+  if (len < size) {
+    len += snprintf(buf + len, size - len, ",\"websocket\":");
+    if (len < size) len += writeWsHealthJson(buf + len, size - len);
+  }
+#endif
+#endif
+  if (len < size) snprintf(buf + len, size - len, "}");
+}
+
+// Per-item results of the last batched (array) status payload
+InputResult batchResults[MAX_BATCH_ITEMS];
+uint8_t batchCount = 0;
+
+// Build aggregated batch response JSON into buffer (HTTP POST /status with array body)
+void buildBatchResponseJson(char* buf, size_t size) {
+  int applied = 0;
+  for (uint8_t i = 0; i < batchCount; i++) {
+    if (batchResults[i] == INPUT_APPLIED) applied++;
+  }
+  size_t len = snprintf(buf, size, "{\"success\":true,\"count\":%d,\"applied\":%d,\"results\":[",
+    batchCount, applied);
+  for (uint8_t i = 0; i < batchCount && len < size; i++) {
+    const char* item;
+    switch (batchResults[i]) {
+      case INPUT_APPLIED:   item = "{\"applied\":true}"; break;
+      case INPUT_DUPLICATE: item = "{\"applied\":false,\"duplicate\":true}"; break;
+      case INPUT_BLOCKED:   item = "{\"applied\":false,\"blocked\":true}"; break;
+      case INPUT_THROTTLED: item = "{\"applied\":false,\"throttled\":true}"; break;
+      case INPUT_COALESCED: item = "{\"applied\":false,\"coalesced\":true}"; break;
+      default:              item = "{\"applied\":false,\"invalid\":true}"; break;
+    }
+    len += snprintf(buf + len, size - len, "%s%s", i > 0 ? "," : "", item);
+  }
+  if (len < size) snprintf(buf + len, size - len, "]}");
 }
 
 // =============================================================================
 // Command Handler
 // =============================================================================
 
-// Handle command-type input (lock/unlock/reboot/status/lock-mode)
-// Returns true if the command was handled
+// Handle command-type input (lock/unlock/reboot/status/lock-mode/view/metrics/stats/latency/trace)
+// Returns true if the command was handled.
+// Commands are the control lane: they run immediately, ahead of queued status
+// updates. Commands that change the lock first apply the queue (cheap, no
+// rendering) so they observe every status update that arrived before them.
 bool handleCommand(const char* command, JsonObject doc) {
+  Print& out = *commandReply;
   if (strcmp(command, "lock") == 0) {
+    drainStatusQueue();
     const char* projectToLock = doc["project"] | currentProject;
     if (strlen(projectToLock) > 0) {
       lockProject(projectToLock);
     } else {
-      Serial.println("{\"error\":\"No project to lock\"}");
+      out.println("{\"error\":\"No project to lock\"}");
     }
     return true;
   }
   if (strcmp(command, "unlock") == 0) {
+    drainStatusQueue();
     unlockProject();
     return true;
   }
   if (strcmp(command, "reboot") == 0) {
-    Serial.println("{\"success\":true,\"rebooting\":true}");
+    out.println("{\"success\":true,\"rebooting\":true}");
+    persistBeforeRestart();
     delay(100);  // Allow serial output to complete
     ESP.restart();
     return true;
   }
   if (strcmp(command, "status") == 0) {
-    char buf[256];
+    char buf[STATUS_JSON_SIZE];
     buildStatusJson(buf, sizeof(buf));
-    Serial.println(buf);
+    out.println(buf);
+    return true;
+  }
+  if (strcmp(command, "metrics") == 0) {
+    char buf[METRICS_JSON_SIZE];
+    buildMetricsJson(buf, sizeof(buf));
+    out.println(buf);
+    return true;
+  }
+  if (strcmp(command, "stats") == 0) {
+    writeStatsJson(out);
+    out.println();
+    return true;
+  }
+  if (strcmp(command, "latency") == 0) {
+    if (doc["reset"] | false) {
+      resetLatencyStats();
+      out.println("{\"latency\":\"reset\"}");
+    } else {
+      writeLatencyJson(out);
+      out.println();
+    }
+    return true;
+  }
+  if (strcmp(command, "trace") == 0) {
+#ifdef USE_TRACE
+    if (commandReply != &Serial) {
+      out.println("{\"error\":\"Binary dump: use Serial or GET /trace\"}");
+      return true;
+    }
+    // JSON header line, then the binary dump (see tools/trace_to_chrome.py)
+    out.print("{\"trace\":");
+    out.print((unsigned long)getTraceCount());
+    out.print(",\"bytes\":");
+    out.print((unsigned long)getTraceDumpSize());
+    out.println("}");
+    writeTrace(out);
+    out.println();
+#else
+    out.println("{\"error\":\"Tracing disabled (build with USE_TRACE)\"}");
+#endif
     return true;
   }
   if (strcmp(command, "lock-mode") == 0) {
@@ -60,14 +190,31 @@ bool handleCommand(const char* command, JsonObject doc) {
     if (strlen(modeStr) > 0) {
       int newMode = parseLockMode(modeStr);
       if (newMode >= 0) {
+        drainStatusQueue();
         setLockMode(newMode);
       } else {
-        Serial.println("{\"error\":\"Invalid mode. Valid modes: first-project, on-thinking\"}");
+        out.println("{\"error\":\"Invalid mode. Valid modes: first-project, on-thinking\"}");
       }
     } else {
-      Serial.print("{\"mode\":\"");
-      Serial.print(getLockModeString());
-      Serial.println("\"}");
+      out.print("{\"mode\":\"");
+      out.print(getLockModeString());
+      out.println("\"}");
+    }
+    return true;
+  }
+  if (strcmp(command, "view") == 0) {
+    const char* modeStr = doc["mode"] | "";
+    if (strlen(modeStr) > 0) {
+      int newMode = parseViewMode(modeStr);
+      if (newMode >= 0) {
+        setViewMode(newMode);
+      } else {
+        out.println("{\"error\":\"Invalid mode. Valid modes: single, dashboard, rotation\"}");
+      }
+    } else {
+      out.print("{\"view\":\"");
+      out.print(getViewModeString());
+      out.println("\"}");
     }
     return true;
   }
@@ -78,12 +225,19 @@ bool handleCommand(const char* command, JsonObject doc) {
 // Status Data Processing
 // =============================================================================
 
-// Forward declaration
+// Forward declarations
 bool processStatusData(JsonObject doc);
+bool admitStatusUpdate(StatusUpdate& update);
+InputResult processThrottledStatus(JsonObject doc, InputSource source);
+InputResult processStatusInput(JsonObject doc, InputSource source);
+InputResult processStatusBatch(JsonArray items, InputSource source);
+#if defined(USE_WIFI) && defined(USE_WS_SERVER)
+void setWsSubscription(uint32_t num, bool subscribed);
+#endif
 
-// Handle WebSocket message-type input (authenticated/error/status)
+// Handle WebSocket message-type input (authenticated/error/status/subscribe/unsubscribe)
 // Returns true if the message was handled
-bool handleWebSocketMessage(const char* msgType, JsonObject doc) {
+bool handleWebSocketMessage(const char* msgType, JsonObject doc, InputSource source) {
   if (strcmp(msgType, "authenticated") == 0) {
     Serial.println("{\"websocket\":\"authenticated\"}");
     return true;
@@ -95,13 +249,25 @@ bool handleWebSocketMessage(const char* msgType, JsonObject doc) {
     Serial.println("\"}");
     return true;
   }
+#if defined(USE_WIFI) && defined(USE_WS_SERVER)
+  if (strcmp(msgType, "subscribe") == 0 || strcmp(msgType, "unsubscribe") == 0) {
+    // LAN WebSocket clients only (state pushes, see ws_server.h)
+    if (source == INPUT_WEBSOCKET_LAN) setWsSubscription(inputSourceId, msgType[0] == 's');
+    return true;
+  }
+#endif
   if (strcmp(msgType, "status") == 0 && doc.containsKey("data")) {
+    // Batched relay frame: {type: "status", data: [{...}, {...}]}
+    if (doc["data"].is<JsonArray>()) {
+      (void)processStatusBatch(doc["data"].as<JsonArray>(), source);
+      return true;
+    }
     JsonObject data = doc["data"];
     if (data.isNull()) {
       Serial.println("{\"error\":\"Invalid status data\"}");
       return true;
     }
-    (void)processStatusData(data);  // Return value intentionally ignored (WebSocket has no response channel)
+    (void)processStatusInput(data, source);  // Return value intentionally ignored (WebSocket has no response channel)
     return true;
   }
   return false;
@@ -111,69 +277,193 @@ bool handleWebSocketMessage(const char* msgType, JsonObject doc) {
 // Main Input Processing
 // =============================================================================
 
-bool processInput(const char* input) {
+// Shared document for payloads that don't fit the stack document (batches).
+// Safe as a single instance: all transports are serviced from loop().
+StaticJsonDocument<JSON_BATCH_BUFFER_SIZE> batchDoc;
+
+// Route a parsed payload: command, WebSocket message, status batch or single status
+InputResult dispatchInput(JsonVariant root, InputSource source) {
+  // Batched format: [{state: "...", project: "..."}, ...]
+  if (root.is<JsonArray>()) {
+    return processStatusBatch(root.as<JsonArray>(), source);
+  }
+
+  JsonObject obj = root.as<JsonObject>();
+
+  // Handle command (lock/unlock/reboot/status/lock-mode/view/metrics/stats/latency/trace) - control lane
+  const char* command = root["command"] | "";
+  if (strlen(command) > 0 && handleCommand(command, obj)) {
+    recordLaneLatency(LANE_CONTROL, inputReceivedUs);
+    return INPUT_APPLIED;
+  }
+
+  // Handle WebSocket message types (server sends {type: "status", data: {...}})
+  const char* msgType = root["type"] | "";
+  if (strlen(msgType) > 0 && handleWebSocketMessage(msgType, obj, source)) return INPUT_APPLIED;
+
+  // Direct format: {state: "...", project: "...", ...}
+  return processStatusInput(obj, source);
+}
+
+// Record where and when the input being processed arrived. sourceId
+// identifies the sender within a transport (remote IP for HTTP and UDP,
+// connection ID for WebSocket) for per-source rate limiting.
+void beginInput(InputSource source, uint32_t sourceId) {
+  inputReceivedUs = micros();
+  inputSource = source;
+  inputSourceId = sourceId;
+}
+
+InputResult processInput(const char* input, InputSource source, uint32_t sourceId) {
+  TRACE_SCOPE(TRACE_PROCESS_INPUT, source);
+  beginInput(source, sourceId);
   StaticJsonDocument<JSON_BUFFER_SIZE> doc;
   DeserializationError error = deserializeJson(doc, input);
 
+  if (error == DeserializationError::NoMemory) {
+    // Too large for the stack document (typically a batch): retry in batchDoc
+    error = deserializeJson(batchDoc, input);
+    if (!error) return dispatchInput(batchDoc.as<JsonVariant>(), source);
+  }
+
   if (error) {
     Serial.println("{\"error\":\"JSON parse error\"}");
-    return false;
+    return INPUT_INVALID;
   }
 
-  JsonObject obj = doc.as<JsonObject>();
+  return dispatchInput(doc.as<JsonVariant>(), source);
+}
 
-  // Handle command (lock/unlock/reboot/status/lock-mode)
-  const char* command = doc["command"] | "";
-  if (strlen(command) > 0 && handleCommand(command, obj)) return true;
+// Apply an array of status objects in order. Each item goes through the same
+// de-dup and processStatusData() path as a single update, so consecutive items
+// for one project coalesce in the status queue and the batch costs one drawStatus().
+InputResult processStatusBatch(JsonArray items, InputSource source) {
+  if (items.size() > MAX_BATCH_ITEMS) {
+    Serial.println("{\"error\":\"Batch too large\"}");
+    batchCount = 0;
+    return INPUT_INVALID;
+  }
 
-  // Handle WebSocket message types (server sends {type: "status", data: {...}})
-  const char* msgType = doc["type"] | "";
-  if (strlen(msgType) > 0 && handleWebSocketMessage(msgType, obj)) return true;
+  batchCount = 0;
+  for (JsonVariant item : items) {
+    InputResult result = INPUT_INVALID;
+    if (item.is<JsonObject>()) {
+      result = processStatusInput(item.as<JsonObject>(), source);
+    }
+    batchResults[batchCount++] = result;
+  }
+  return INPUT_BATCH;
+}
 
-  // Direct format: {state: "...", project: "...", ...}
-  return processStatusData(obj);
+// Admission stages in front of processStatusData():
+// 1. Token bucket per source: over-limit updates are merged into the queue
+//    tail if it already holds their project, otherwise dropped. They never
+//    go through admission (no interning, auto-lock or snapshot).
+// 2. De-dup: copies of an event (e.g. HTTP hook + cloud relay) are dropped
+//    before they touch any state.
+InputResult processStatusInput(JsonObject doc, InputSource source) {
+  if (!takeRateToken(source, inputSourceId)) {
+    return processThrottledStatus(doc, source);
+  }
+  rateAdmitted[source]++;
+
+  if (isDuplicateStatus(doc, source)) return INPUT_DUPLICATE;
+  return processStatusData(doc) ? INPUT_APPLIED : INPUT_BLOCKED;
 }
 
-bool processStatusData(JsonObject doc) {
-  // Get incoming project
-  const char* incomingProject = doc["project"] | "";
+// Over-limit update: only a lookup decides whether the queue tail holds its
+// project (the tail was admitted, and the lock is re-checked on apply)
+InputResult processThrottledStatus(JsonObject doc, InputSource source) {
+  StatusUpdate update;
+  parseStatusUpdate(doc, update);
+  stampProbe(update.probe, source, inputReceivedUs);
 
-  // Add incoming project to list
-  if (strlen(incomingProject) > 0) {
-    addProjectToList(incomingProject);
+  ProjectId id = findProject(update.project);
+  bool known = id != PROJECT_NONE || strlen(update.project) == 0;
+  if (known && isQueueTail(id)) {
+    if (isDuplicateStatus(doc, source)) return INPUT_DUPLICATE;
+    update.projectId = id;
+    coalesceIntoTail(update);
+    rateCoalesced[source]++;
+    return INPUT_COALESCED;
+  }
+  rateDropped[source]++;
+  finishProbe(update.probe, PROBE_THROTTLED);
+  return INPUT_THROTTLED;
+}
+
+// Admit a status update: intern the project (sets update.projectId), apply
+// auto-lock, and reject updates from non-locked projects. Runs immediately so
+// the caller gets an applied/blocked answer; field changes are applied later
+// from the queue.
+bool admitStatusUpdate(StatusUpdate& update) {
+  // Add incoming project to the table (PROJECT_NONE if not specified) and
+  // record the update in its snapshot, even if it ends up blocked
+  ProjectId id = internProject(update.project);
+  update.projectId = id;
+  if (id != PROJECT_NONE) {
+    ProjectSnapshot& snapshot = projectTable[id].snapshot;
+    ProjectSnapshot before = snapshot;
+    mergeStatusUpdate(snapshot, update, STATE_IDLE);  // Shown as idle until a state arrives
+    snapshot.updatedAt = millis();
+    recordProjectHistory(id, before, snapshot);
   }
 
-  // Auto-lock based on lockMode
-  if (lockMode == LOCK_MODE_FIRST_PROJECT) {
+  // Auto-lock based on lockMode (rotation mode manages the lock itself)
+  if (viewMode == VIEW_MODE_ROTATION) {
+    // No auto-lock
+  } else if (lockMode == LOCK_MODE_FIRST_PROJECT) {
     // First project gets locked automatically
-    if (strlen(incomingProject) > 0 && projectCount == 1 && strlen(lockedProject) == 0) {
-      safeCopyStr(lockedProject, incomingProject);
+    if (id != PROJECT_NONE && projectCount == 1 && lockedProjectId == PROJECT_NONE) {
+      lockedProjectId = id;
     }
   } else if (lockMode == LOCK_MODE_ON_THINKING) {
     // Lock on thinking state
-    const char* stateStr = doc["state"] | "";
-    if (strcmp(stateStr, "thinking") == 0 && strlen(incomingProject) > 0) {
-      safeCopyStr(lockedProject, incomingProject);
+    if (update.state == STATE_THINKING && id != PROJECT_NONE) {
+      lockedProjectId = id;
     }
   }
 
   // Check if update should be blocked due to project lock
-  if (isLockedToDifferentProject(incomingProject)) {
-    // Silently ignore update from different project
-    Serial.println("{\"success\":false,\"blocked\":true}");
+  if (isLockedToDifferentProject(id)) {
+    // Silently ignore update from different project (in rotation mode it is
+    // not blocked: it waits in the snapshot for the project's turn)
+    if (viewMode != VIEW_MODE_ROTATION) {
+      Serial.println("{\"success\":false,\"blocked\":true}");
+    }
     return false;
   }
+  return true;
+}
+
+// Status lane entry point: parse, admit, and queue for application in loop()
+bool processStatusData(JsonObject doc) {
+  StatusUpdate update;
+  parseStatusUpdate(doc, update);
+  update.receivedUs = inputReceivedUs;
+  stampProbe(update.probe, inputSource, inputReceivedUs);
+
+  if (!admitStatusUpdate(update)) {
+    bool deferred = viewMode == VIEW_MODE_ROTATION;  // Recorded in the snapshot
+    finishProbe(update.probe, deferred ? PROBE_DEFERRED : PROBE_BLOCKED);
+    return deferred;
+  }
 
+  enqueueStatusUpdate(update);
+  return true;
+}
+
+// Apply a queued status update to the display state and set dirty flags
+void applyStatusUpdate(const StatusUpdate& update) {
   previousState = currentState;
 
   // Track if info fields changed (for redraw when state is same)
   // IMPORTANT: Must be declared BEFORE processing any fields
   bool infoChanged = false;
 
-  // Parse state
-  const char* stateStr = doc["state"] | "";
-  if (strlen(stateStr) > 0) {
-    AppState newState = parseState(stateStr);
+  // State
+  if (update.state >= 0) {
+    AppState newState = (AppState)update.state;
     // Clear tool when state changes (tool is only relevant for working state)
     if (newState != currentState) {
       currentTool[0] = '\0';
@@ -181,21 +471,19 @@ bool processStatusData(JsonObject doc) {
     currentState = newState;
   }
 
-  // Parse project - check for change and clear dependent fields
-  const char* newProject = doc["project"] | "";
-  if (strlen(newProject) > 0 && strcmp(newProject, currentProject) != 0) {
+  // Project - check for change and clear dependent fields
+  if (strlen(update.project) > 0 && strcmp(update.project, currentProject) != 0) {
     // Project changed - clear model/memory and trigger redraw
     currentModel[0] = '\0';
     currentMemory = 0;
     currentTool[0] = '\0';
     infoChanged = true;
-    safeCopyStr(currentProject, newProject);
+    safeCopyStr(currentProject, update.project);
   }
 
-  // Parse tool
-  const char* toolStr = doc["tool"] | "";
-  if (strlen(toolStr) > 0 && strcmp(toolStr, currentTool) != 0) {
-    safeCopyStr(currentTool, toolStr);
+  // Tool
+  if (strlen(update.tool) > 0 && strcmp(update.tool, currentTool) != 0) {
+    safeCopyStr(currentTool, update.tool);
     infoChanged = true;
     // Tool change affects status text in working state
     if (currentState == STATE_WORKING) {
@@ -203,24 +491,21 @@ bool processStatusData(JsonObject doc) {
     }
   }
 
-  // Parse model
-  const char* modelStr = doc["model"] | "";
-  if (strlen(modelStr) > 0 && strcmp(modelStr, currentModel) != 0) {
-    safeCopyStr(currentModel, modelStr);
+  // Model
+  if (strlen(update.model) > 0 && strcmp(update.model, currentModel) != 0) {
+    safeCopyStr(currentModel, update.model);
     infoChanged = true;
   }
 
-  // Parse memory (number 0-100, clamped to valid range)
-  int memoryVal = doc["memory"] | -1;
-  if (memoryVal >= 0 && memoryVal <= 100 && memoryVal != currentMemory) {
-    currentMemory = memoryVal;
+  // Memory (already validated to 0-100 by parseStatusUpdate)
+  if (update.memory >= 0 && update.memory != currentMemory) {
+    currentMemory = update.memory;
     infoChanged = true;
   }
 
-  // Parse character (use isValidCharacter() for dynamic validation)
-  const char* charInput = doc["character"] | "";
-  if (strlen(charInput) > 0 && isValidCharacter(charInput) && strcmp(charInput, currentCharacter) != 0) {
-    safeCopyStr(currentCharacter, charInput);
+  // Character (already validated by parseStatusUpdate)
+  if (strlen(update.character) > 0 && strcmp(update.character, currentCharacter) != 0) {
+    safeCopyStr(currentCharacter, update.character);
     infoChanged = true;
   }
 
@@ -237,7 +522,7 @@ bool processStatusData(JsonObject doc) {
     // Same state but info changed - only redraw info section
     dirtyInfo = true;
   }
-  return true;
+  TRACE_INSTANT(TRACE_DIRTY, TRACE_DIRTY_BITS());
 }
 
 #endif // INPUT_H
@@ -0,0 +1,158 @@
+/*
+ * VibeMon JSON Writer
+ * Streaming JSON output without heap allocation: values are escaped into a
+ * fixed buffer, which is handed to a sink each time it fills up (or kept,
+ * and marked truncated, when there is no sink). Commas are placed
+ * automatically.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#define JSON_WRITER_DEPTH 8  // Deeper nesting is written, commas are not tracked
+
+typedef void (*JsonSink)(const char* data, size_t len);
+
+struct JsonWriter {
+  char* buf;
+  size_t size;
+  size_t len;
+  JsonSink sink;        // nullptr: output stops (truncated) when buf is full
+  bool truncated;
+  uint8_t depth;
+  uint8_t hasValue;     // Bit per nesting level: a value was written (comma next)
+  bool afterKey;        // Next value follows "key": (no comma)
+};
+
+void jsonBegin(JsonWriter& w, char* buf, size_t size, JsonSink sink = nullptr) {
+  w = JsonWriter{buf, size, 0, sink, false, 0, 0, false};
+}
+
+// Hand what is buffered to the sink (call once at the end)
+void jsonFlush(JsonWriter& w) {
+  if (w.sink && w.len > 0) w.sink(w.buf, w.len);
+  w.len = 0;
+}
+
+void jsonPut(JsonWriter& w, char c) {
+  if (w.len == w.size) {
+    if (!w.sink) {
+      w.truncated = true;
+      return;
+    }
+    jsonFlush(w);
+  }
+  w.buf[w.len++] = c;
+}
+
+void jsonPutRaw(JsonWriter& w, const char* s) {
+  while (*s) jsonPut(w, *s++);
+}
+
+// Comma before a value or key, unless it opens its container or follows a key
+void jsonSeparate(JsonWriter& w) {
+  if (w.afterKey) {
+    w.afterKey = false;
+    return;
+  }
+  uint8_t bit = w.depth < JSON_WRITER_DEPTH ? 1 << w.depth : 0;
+  if (w.hasValue & bit) jsonPut(w, ',');
+  w.hasValue |= bit;
+}
+
+// Quoted, escaped string. Bytes 0x80 and up (UTF-8) are copied unchanged.
+void jsonPutString(JsonWriter& w, const char* s) {
+  static const char HEX[] = "0123456789abcdef";
+  jsonPut(w, '"');
+  for (; *s; s++) {
+    uint8_t c = (uint8_t)*s;
+    if (c == '"' || c == '\\') {
+      jsonPut(w, '\\');
+      jsonPut(w, c);
+    } else if (c == '\n') {
+      jsonPutRaw(w, "\\n");
+    } else if (c == '\r') {
+      jsonPutRaw(w, "\\r");
+    } else if (c == '\t') {
+      jsonPutRaw(w, "\\t");
+    } else if (c < 0x20) {
+      jsonPutRaw(w, "\\u00");
+      jsonPut(w, HEX[c >> 4]);
+      jsonPut(w, HEX[c & 0x0F]);
+    } else {
+      jsonPut(w, c);
+    }
+  }
+  jsonPut(w, '"');
+}
+
+// =============================================================================
+// Values
+// =============================================================================
+
+void jsonBeginObject(JsonWriter& w) {
+  jsonSeparate(w);
+  jsonPut(w, '{');
+  w.depth++;
+  if (w.depth < JSON_WRITER_DEPTH) w.hasValue &= ~(1 << w.depth);
+}
+
+void jsonEndObject(JsonWriter& w) {
+  w.depth--;
+  jsonPut(w, '}');
+}
+
+void jsonBeginArray(JsonWriter& w) {
+  jsonSeparate(w);
+  jsonPut(w, '[');
+  w.depth++;
+  if (w.depth < JSON_WRITER_DEPTH) w.hasValue &= ~(1 << w.depth);
+}
+
+void jsonEndArray(JsonWriter& w) {
+  w.depth--;
+  jsonPut(w, ']');
+}
+
+void jsonKey(JsonWriter& w, const char* key) {
+  jsonSeparate(w);
+  jsonPutString(w, key);
+  jsonPut(w, ':');
+  w.afterKey = true;
+}
+
+void jsonString(JsonWriter& w, const char* value) {
+  jsonSeparate(w);
+  jsonPutString(w, value);
+}
+
+void jsonInt(JsonWriter& w, long value) {
+  char num[21];
+  snprintf(num, sizeof(num), "%ld", value);
+  jsonSeparate(w);
+  jsonPutRaw(w, num);
+}
+
+void jsonBool(JsonWriter& w, bool value) {
+  jsonSeparate(w);
+  jsonPutRaw(w, value ? "true" : "false");
+}
+
+void jsonNull(JsonWriter& w) {
+  jsonSeparate(w);
+  jsonPutRaw(w, "null");
+}
+
+// Print a short string (a project or tool name, up to 31 bytes) quoted and
+// escaped to `out` (anything with print(const char*))
+template <typename Out>
+void jsonPrintString(Out& out, const char* s) {
+  char quoted[32 * 6 + 3];  // Every byte as \u00XX
+  JsonWriter w;
+  jsonBegin(w, quoted, sizeof(quoted) - 1);
+  jsonString(w, s);
+  quoted[w.len] = '\0';
+  out.print(quoted);
+}
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,238 @@
+/*
+ * VibeMon Latency
+ * End-to-end probes: status updates carrying a probe ID are timed from
+ * receive to parse done and to the panel flush, with per-transport
+ * histograms and a ring of recent probe results
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+// =============================================================================
+// Probe Record
+// =============================================================================
+
+// Probe carried by a status update ({"probe": id, "ts": senderTime})
+struct LatencyProbe {
+  uint32_t id;               // 0 = not a probe
+  uint32_t ts;               // Sender timestamp, echoed back unchanged
+  uint8_t source;            // InputSource
+  unsigned long receivedUs;  // micros() when processInput() started
+  unsigned long parsedUs;    // micros() when the status was parsed
+};
+
+// What happened to a probe
+enum ProbeOutcome : uint8_t {
+  PROBE_SHOWN,      // Applied and flushed to the panel (or nothing to redraw)
+  PROBE_BLOCKED,    // Project not locked
+  PROBE_DEFERRED,   // Rotation: kept for the project's turn
+  PROBE_THROTTLED,  // Over the rate limit, dropped
+  PROBE_COALESCED,  // Merged into an earlier probe's update
+  PROBE_DROPPED     // Discarded from the queue (lock moved, project evicted)
+};
+
+struct ProbeResult {
+  uint32_t id;
+  uint32_t ts;
+  uint32_t parseUs;  // Receive to parsed
+  uint32_t glassUs;  // Receive to flushed (PROBE_SHOWN only)
+  uint8_t source;
+  uint8_t outcome;
+};
+
+ProbeResult probeResults[LATENCY_RESULTS];
+uint8_t probeResultNext = 0;
+uint8_t probeResultCount = 0;
+
+// Applied probes waiting for the frame that shows them
+LatencyProbe probePending[STATUS_QUEUE_SIZE];
+uint8_t probePendingCount = 0;
+
+// =============================================================================
+// Histograms
+// =============================================================================
+
+// Log2 buckets: bucket 0 is < 256us, bucket i is [2^(i+7), 2^(i+8)) us,
+// the last one open-ended (>= ~4.2s)
+#define LATENCY_BUCKETS 16
+
+struct LatencyHistogram {
+  uint32_t counts[LATENCY_BUCKETS];
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+};
+
+LatencyHistogram latencyParse[INPUT_SOURCE_COUNT];
+LatencyHistogram latencyGlass[INPUT_SOURCE_COUNT];
+
+int getLatencyBucket(uint32_t us) {
+  int bucket = 0;
+  for (uint32_t bound = 256; bucket < LATENCY_BUCKETS - 1 && us >= bound; bound <<= 1) bucket++;
+  return bucket;
+}
+
+// Upper bound of a bucket in us (0 for the open-ended last bucket)
+uint32_t getLatencyBucketBound(int bucket) {
+  return bucket < LATENCY_BUCKETS - 1 ? 256UL << bucket : 0;
+}
+
+void addLatencySample(LatencyHistogram& histogram, uint32_t us) {
+  histogram.counts[getLatencyBucket(us)]++;
+  histogram.count++;
+  histogram.totalUs += us;
+  if (us > histogram.maxUs) histogram.maxUs = us;
+}
+
+// Percentile estimate: upper bound of the bucket holding it (max for the last)
+uint32_t getLatencyPercentile(const LatencyHistogram& histogram, int percent) {
+  if (histogram.count == 0) return 0;
+  uint32_t rank = (histogram.count * (uint32_t)percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += histogram.counts[i];
+    if (seen >= rank) {
+      uint32_t bound = getLatencyBucketBound(i);
+      return (bound == 0 || bound > histogram.maxUs) ? histogram.maxUs : bound;
+    }
+  }
+  return histogram.maxUs;
+}
+
+void resetLatencyStats() {
+  memset(latencyParse, 0, sizeof(latencyParse));
+  memset(latencyGlass, 0, sizeof(latencyGlass));
+  probeResultNext = 0;
+  probeResultCount = 0;
+}
+
+// =============================================================================
+// Probe Tracking
+// =============================================================================
+
+// Fill in where and when a probe arrived (called once its status is parsed)
+void stampProbe(LatencyProbe& probe, InputSource source, unsigned long receivedUs) {
+  if (probe.id == 0) return;
+  probe.source = source;
+  probe.receivedUs = receivedUs;
+  probe.parsedUs = micros();
+}
+
+// Record the outcome of a probe. glassUs is only used for PROBE_SHOWN.
+void finishProbe(const LatencyProbe& probe, ProbeOutcome outcome, uint32_t glassUs = 0) {
+  if (probe.id == 0) return;
+  ProbeResult& result = probeResults[probeResultNext];
+  result.id = probe.id;
+  result.ts = probe.ts;
+  result.parseUs = (uint32_t)(probe.parsedUs - probe.receivedUs);
+  result.glassUs = glassUs;
+  result.source = probe.source;
+  result.outcome = outcome;
+  probeResultNext = (probeResultNext + 1) % LATENCY_RESULTS;
+  if (probeResultCount < LATENCY_RESULTS) probeResultCount++;
+
+  if (probe.source < INPUT_SOURCE_COUNT) {
+    addLatencySample(latencyParse[probe.source], result.parseUs);
+    if (outcome == PROBE_SHOWN) addLatencySample(latencyGlass[probe.source], glassUs);
+  }
+}
+
+// A probe's update was applied: it is shown by the next flushed frame
+void awaitProbeFlush(const LatencyProbe& probe) {
+  if (probe.id == 0) return;
+  if (probePendingCount == STATUS_QUEUE_SIZE) {
+    finishProbe(probe, PROBE_DROPPED);  // More applies than one loop can queue
+    return;
+  }
+  probePending[probePendingCount++] = probe;
+}
+
+// Called from loop() after rendering: once no region is left dirty, every
+// pending probe is on glass (drawing is synchronous: when drawStatus()
+// returns, its pixels have been pushed to the panel)
+void completeProbeFlushes() {
+  if (probePendingCount == 0) return;
+  // The dashboard redraws changed tiles every pass and leaves the flags alone
+  bool dirty = needsRedraw || dirtyCharacter || dirtyStatus || dirtyInfo;
+  if (dirty && viewMode != VIEW_MODE_DASHBOARD) return;
+  unsigned long now = micros();
+  for (uint8_t i = 0; i < probePendingCount; i++) {
+    finishProbe(probePending[i], PROBE_SHOWN, (uint32_t)(now - probePending[i].receivedUs));
+  }
+  probePendingCount = 0;
+}
+
+// Merge a probe into a queued update's: the earlier probe stays (its wait is
+// the longer one), the later one is reported as coalesced
+void mergeProbe(LatencyProbe& queued, const LatencyProbe& probe) {
+  if (probe.id == 0) return;
+  if (queued.id == 0) {
+    queued = probe;
+  } else {
+    finishProbe(probe, PROBE_COALESCED);
+  }
+}
+
+// =============================================================================
+// Latency JSON (streamed)
+// =============================================================================
+
+const char* getProbeOutcomeString(uint8_t outcome) {
+  switch (outcome) {
+    case PROBE_SHOWN: return "shown";
+    case PROBE_BLOCKED: return "blocked";
+    case PROBE_DEFERRED: return "deferred";
+    case PROBE_THROTTLED: return "throttled";
+    case PROBE_COALESCED: return "coalesced";
+    default: return "dropped";
+  }
+}
+
+template <typename Out>
+void writeLatencyHistogram(Out& out, const char* name, const LatencyHistogram& histogram) {
+  char line[160];
+  snprintf(line, sizeof(line),
+    "\"%s\":{\"count\":%lu,\"avgUs\":%lu,\"p50Us\":%lu,\"p95Us\":%lu,\"p99Us\":%lu,\"maxUs\":%lu,\"buckets\":[",
+    name, (unsigned long)histogram.count,
+    (unsigned long)(histogram.count > 0 ? histogram.totalUs / histogram.count : 0),
+    (unsigned long)getLatencyPercentile(histogram, 50),
+    (unsigned long)getLatencyPercentile(histogram, 95),
+    (unsigned long)getLatencyPercentile(histogram, 99),
+    (unsigned long)histogram.maxUs);
+  out.print(line);
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    snprintf(line, sizeof(line), "%s%lu", i > 0 ? "," : "", (unsigned long)histogram.counts[i]);
+    out.print(line);
+  }
+  out.print("]}");
+}
+
+// Histograms per transport, then recent probe results oldest first as
+// [id, ts, source, outcome, parseUs, glassUs]
+template <typename Out>
+void writeLatencyJson(Out& out) {
+  char line[96];
+  out.print("{\"transports\":{");
+  for (int i = 0; i < INPUT_SOURCE_COUNT; i++) {
+    snprintf(line, sizeof(line), "%s\"%s\":{", i > 0 ? "," : "", getInputSourceString((InputSource)i));
+    out.print(line);
+    writeLatencyHistogram(out, "parse", latencyParse[i]);
+    out.print(",");
+    writeLatencyHistogram(out, "glass", latencyGlass[i]);
+    out.print("}");
+  }
+
+  out.print("},\"probes\":[");
+  uint8_t oldest = (probeResultNext + LATENCY_RESULTS - probeResultCount) % LATENCY_RESULTS;
+  for (uint8_t i = 0; i < probeResultCount; i++) {
+    const ProbeResult& result = probeResults[(oldest + i) % LATENCY_RESULTS];
+    snprintf(line, sizeof(line), "%s[%lu,%lu,\"%s\",\"%s\",%lu,%lu]", i > 0 ? "," : "",
+      (unsigned long)result.id, (unsigned long)result.ts,
+      getInputSourceString((InputSource)result.source), getProbeOutcomeString(result.outcome),
+      (unsigned long)result.parseUs, (unsigned long)result.glassUs);
+    out.print(line);
+  }
+  out.print("]}");
+}
+
+#endif // LATENCY_H
@@ -1,77 +1,174 @@
 /*
  * VibeMon Project Lock
- * Project lock/unlock and lock mode management
+ * Project table, lock/unlock and lock mode management
  */
 
 #ifndef PROJECT_LOCK_H
 #define PROJECT_LOCK_H
 
 // =============================================================================
-// Project List Management
+// Project Table
 // =============================================================================
 
-// Check if project exists in list
-bool projectExists(const char* project) {
-  for (int i = 0; i < projectCount; i++) {
-    if (strcmp(projectList[i], project) == 0) {
-      return true;
-    }
+// Forward declaration (defined in status_queue.h)
+void forgetQueuedProject(ProjectId id);
+
+// Clear the table and hash index (called from setup())
+void resetProjectTable() {
+  for (int i = 0; i < PROJECT_HASH_BUCKETS; i++) {
+    projectBuckets[i] = PROJECT_NONE;
+  }
+  projectLruHead = PROJECT_NONE;
+  projectLruTail = PROJECT_NONE;
+  projectCount = 0;
+  lockedProjectId = PROJECT_NONE;
+}
+
+// Find a project by name via the hash index. Returns PROJECT_NONE if absent.
+// Names are compared as stored: truncated to 31 chars.
+ProjectId findProject(const char* name) {
+  if (strlen(name) == 0) return PROJECT_NONE;
+  char key[sizeof(projectTable[0].name)];
+  safeCopyStr(key, name);
+  uint32_t hash = fnv1a(key);
+  ProjectId id = projectBuckets[hash & (PROJECT_HASH_BUCKETS - 1)];
+  while (id != PROJECT_NONE) {
+    const ProjectEntry& entry = projectTable[id];
+    if (entry.hash == hash && strcmp(entry.name, key) == 0) return id;
+    id = entry.nextInBucket;
   }
-  return false;
+  return PROJECT_NONE;
+}
+
+// Project name for an ID ("" for PROJECT_NONE)
+const char* getProjectName(ProjectId id) {
+  return id < MAX_PROJECTS ? projectTable[id].name : "";
+}
+
+// Locked project name ("" when unlocked)
+const char* getLockedProject() {
+  return getProjectName(lockedProjectId);
+}
+
+// LRU list helpers (intrusive, O(1))
+void lruUnlink(ProjectId id) {
+  ProjectEntry& entry = projectTable[id];
+  if (entry.lruPrev != PROJECT_NONE) projectTable[entry.lruPrev].lruNext = entry.lruNext;
+  else projectLruHead = entry.lruNext;
+  if (entry.lruNext != PROJECT_NONE) projectTable[entry.lruNext].lruPrev = entry.lruPrev;
+  else projectLruTail = entry.lruPrev;
 }
 
-// Add project to list (if not exists, max 10)
-void addProjectToList(const char* project) {
-  if (strlen(project) == 0) return;
-  if (projectExists(project)) return;
-  if (projectCount >= MAX_PROJECTS) {
-    // Remove oldest project (shift array)
-    for (int i = 0; i < MAX_PROJECTS - 1; i++) {
-      safeCopyStr(projectList[i], projectList[i + 1]);
+void lruPushFront(ProjectId id) {
+  ProjectEntry& entry = projectTable[id];
+  entry.lruPrev = PROJECT_NONE;
+  entry.lruNext = projectLruHead;
+  if (projectLruHead != PROJECT_NONE) projectTable[projectLruHead].lruPrev = id;
+  projectLruHead = id;
+  if (projectLruTail == PROJECT_NONE) projectLruTail = id;
+}
+
+// Remove a project from its hash chain and the LRU list, freeing its ID
+void evictProject(ProjectId id) {
+  ProjectEntry& entry = projectTable[id];
+  ProjectId* link = &projectBuckets[entry.hash & (PROJECT_HASH_BUCKETS - 1)];
+  while (*link != id) link = &projectTable[*link].nextInBucket;
+  *link = entry.nextInBucket;
+  lruUnlink(id);
+  forgetQueuedProject(id);
+}
+
+// Intern a project name: returns its ID, adding it (evicting the least
+// recently used unlocked project when full) if needed. Marks it most recently
+// used. Returns PROJECT_NONE for an empty name.
+ProjectId internProject(const char* name) {
+  if (strlen(name) == 0) return PROJECT_NONE;
+
+  ProjectId id = findProject(name);
+  if (id != PROJECT_NONE) {
+    if (id != projectLruHead) {
+      lruUnlink(id);
+      lruPushFront(id);
     }
-    projectCount = MAX_PROJECTS - 1;
+    return id;
+  }
+
+  if (projectCount < MAX_PROJECTS) {
+    id = projectCount++;
+  } else {
+    // The locked project is pinned: skip it when it is the LRU tail
+    id = projectLruTail;
+    if (id == lockedProjectId) id = projectTable[id].lruPrev;
+    evictProject(id);
   }
-  safeCopyStr(projectList[projectCount], project);
-  projectCount++;
+
+  ProjectEntry& entry = projectTable[id];
+  safeCopyStr(entry.name, name);
+  memset(&entry.snapshot, 0, sizeof(entry.snapshot));
+  entry.snapshot.state = -1;
+  entry.snapshot.memory = -1;
+  entry.hash = fnv1a(entry.name);  // Stored (truncated) name, as in findProject()
+  ProjectId& bucket = projectBuckets[entry.hash & (PROJECT_HASH_BUCKETS - 1)];
+  entry.nextInBucket = bucket;
+  bucket = id;
+  lruPushFront(id);
+  return id;
 }
 
 // =============================================================================
 // Lock/Unlock Functions
 // =============================================================================
 
+// Show a project's last-known status on the single-project screen (idle if
+// nothing was received for it yet). Actual drawStatus() is called in loop().
+void showProjectSnapshot(ProjectId id) {
+  const ProjectSnapshot& snapshot = projectTable[id].snapshot;
+  previousState = currentState;
+  safeCopyStr(currentProject, getProjectName(id));
+  safeCopyStr(currentTool, snapshot.tool);
+  safeCopyStr(currentModel, snapshot.model);
+  currentMemory = snapshot.memory >= 0 ? snapshot.memory : 0;
+  if (strlen(snapshot.character) > 0) {
+    safeCopyStr(currentCharacter, snapshot.character);
+  }
+  if (snapshot.state >= 0) {
+    // Timeouts continue from the last update
+    lastActivityTime = snapshot.updatedAt;
+    currentState = applyStateTimeouts((AppState)snapshot.state, lastActivityTime, millis());
+  } else {
+    currentState = STATE_IDLE;
+    lastActivityTime = millis();
+  }
+  needsRedraw = true;
+  dirtyCharacter = true;
+  dirtyStatus = true;
+  dirtyInfo = true;
+}
+
 // Lock to a specific project
 void lockProject(const char* project) {
   if (strlen(project) > 0) {
-    bool changed = (strcmp(lockedProject, project) != 0);
-    addProjectToList(project);
-    safeCopyStr(lockedProject, project);
+    ProjectId id = internProject(project);
+    bool changed = (id != lockedProjectId);
+    lockedProjectId = id;
 
-    // Transition to idle state when lock changes
-    // (actual drawStatus() is called in loop())
+    // Show the project's last-known status when the lock changes
     if (changed) {
-      previousState = currentState;
-      currentState = STATE_IDLE;
-      safeCopyStr(currentProject, project);
-      currentTool[0] = '\0';
-      currentModel[0] = '\0';
-      currentMemory = 0;
-      lastActivityTime = millis();
-      needsRedraw = true;
-      dirtyCharacter = true;
-      dirtyStatus = true;
-      dirtyInfo = true;
+      showProjectSnapshot(id);
     }
 
-    Serial.print("{\"lockedProject\":\"");
-    Serial.print(lockedProject);
-    Serial.println("\",\"state\":\"idle\"}");
+    commandReply->print("{\"lockedProject\":");
+    jsonPrintString(*commandReply, getLockedProject());
+    commandReply->print(",\"state\":\"");
+    commandReply->print(getStateString(currentState));
+    commandReply->println("\"}");
   }
 }
 
 // Unlock project
 void unlockProject() {
-  lockedProject[0] = '\0';
-  Serial.println("{\"lockedProject\":null}");
+  lockedProjectId = PROJECT_NONE;
+  commandReply->println("{\"lockedProject\":null}");
 }
 
 // =============================================================================
@@ -82,16 +179,15 @@ void unlockProject() {
 void setLockMode(int mode) {
   if (mode == LOCK_MODE_FIRST_PROJECT || mode == LOCK_MODE_ON_THINKING) {
     lockMode = mode;
-    lockedProject[0] = '\0';  // Reset lock when mode changes
+    lockedProjectId = PROJECT_NONE;  // Reset lock when mode changes
 
-    // Persist to flash storage
-    preferences.begin("vibemon", false);  // Read-write mode
-    preferences.putInt("lockMode", lockMode);
-    preferences.end();
+    // Persist to flash storage (written from loop())
+    settings.lockMode = lockMode;
+    markSettingsDirty();
 
-    Serial.print("{\"mode\":\"");
-    Serial.print(mode == LOCK_MODE_FIRST_PROJECT ? "first-project" : "on-thinking");
-    Serial.println("\",\"lockedProject\":null}");
+    commandReply->print("{\"mode\":\"");
+    commandReply->print(mode == LOCK_MODE_FIRST_PROJECT ? "first-project" : "on-thinking");
+    commandReply->println("\",\"lockedProject\":null}");
   }
 }
 
@@ -107,11 +203,11 @@ int parseLockMode(const char* modeStr) {
   return -1;  // Invalid mode
 }
 
-// Check if locked to different project
-bool isLockedToDifferentProject(const char* project) {
-  if (strlen(lockedProject) == 0) return false;  // Not locked
-  if (strlen(project) == 0) return false;  // No project specified
-  return strcmp(lockedProject, project) != 0;
+// Check if locked to different project (integer compare, see internProject())
+bool isLockedToDifferentProject(ProjectId id) {
+  if (lockedProjectId == PROJECT_NONE) return false;  // Not locked
+  if (id == PROJECT_NONE) return false;  // No project specified
+  return id != lockedProjectId;
 }
 
 #endif // PROJECT_LOCK_H
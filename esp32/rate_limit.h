@@ -0,0 +1,83 @@
+/*
+ * VibeMon Rate Limiting
+ * Token-bucket admission control for status updates, per transport and source
+ */
+
+#ifndef RATE_LIMIT_H
+#define RATE_LIMIT_H
+
+// =============================================================================
+// Token Buckets
+// =============================================================================
+
+// One bucket per (transport, source): remote IP for HTTP and UDP, connection
+// for WebSocket (cloud relay and LAN clients alike), a single bucket for Serial. Tokens are kept in thousandths so
+// refill is pure integer math: elapsed_ms * rate_per_sec.
+struct TokenBucket {
+  bool inUse;
+  uint8_t transport;
+  uint32_t sourceId;
+  uint32_t milliTokens;
+  unsigned long lastRefill;
+};
+
+TokenBucket rateBuckets[RATE_LIMIT_SOURCES];
+
+const uint16_t RATE_LIMIT_RATE[INPUT_SOURCE_COUNT] = {
+  RATE_LIMIT_SERIAL_RATE, RATE_LIMIT_HTTP_RATE, RATE_LIMIT_WS_RATE, RATE_LIMIT_UDP_RATE,
+  RATE_LIMIT_WS_RATE
+};
+const uint16_t RATE_LIMIT_BURST[INPUT_SOURCE_COUNT] = {
+  RATE_LIMIT_SERIAL_BURST, RATE_LIMIT_HTTP_BURST, RATE_LIMIT_WS_BURST, RATE_LIMIT_UDP_BURST,
+  RATE_LIMIT_WS_BURST
+};
+
+// Admission counters per transport
+uint32_t rateAdmitted[INPUT_SOURCE_COUNT] = {0};
+uint32_t rateCoalesced[INPUT_SOURCE_COUNT] = {0};  // Over limit, merged into queued update
+uint32_t rateDropped[INPUT_SOURCE_COUNT] = {0};    // Over limit, rejected
+
+// Find the bucket for a source, recycling the least recently refilled one
+TokenBucket& getRateBucket(InputSource transport, uint32_t sourceId) {
+  TokenBucket* victim = &rateBuckets[0];
+  for (int i = 0; i < RATE_LIMIT_SOURCES; i++) {
+    TokenBucket& bucket = rateBuckets[i];
+    if (bucket.inUse && bucket.transport == transport && bucket.sourceId == sourceId) {
+      return bucket;
+    }
+    if (!bucket.inUse) {
+      victim = &bucket;
+    } else if (victim->inUse && bucket.lastRefill < victim->lastRefill) {
+      victim = &bucket;
+    }
+  }
+  // New source starts with a full bucket
+  victim->inUse = true;
+  victim->transport = (uint8_t)transport;
+  victim->sourceId = sourceId;
+  victim->milliTokens = (uint32_t)RATE_LIMIT_BURST[transport] * 1000;
+  victim->lastRefill = millis();
+  return *victim;
+}
+
+// Take one token for a status update. Returns false if the source is over its limit.
+// A rate of 0 disables limiting for that transport.
+bool takeRateToken(InputSource transport, uint32_t sourceId) {
+  if (RATE_LIMIT_RATE[transport] == 0) return true;
+
+  TokenBucket& bucket = getRateBucket(transport, sourceId);
+  unsigned long now = millis();
+  uint32_t capacity = (uint32_t)RATE_LIMIT_BURST[transport] * 1000;
+  unsigned long elapsed = now - bucket.lastRefill;
+  if (elapsed > 0) {
+    uint64_t refilled = (uint64_t)bucket.milliTokens + (uint64_t)elapsed * RATE_LIMIT_RATE[transport];
+    bucket.milliTokens = (refilled > capacity) ? capacity : (uint32_t)refilled;
+    bucket.lastRefill = now;
+  }
+
+  if (bucket.milliTokens < 1000) return false;
+  bucket.milliTokens -= 1000;
+  return true;
+}
+
+#endif // RATE_LIMIT_H
@@ -0,0 +1,266 @@
+/*
+ * VibeMon Rotation
+ * Single-project screen cycling through active projects. The next project's
+ * screen is composed off-screen during the current dwell and pushed at once.
+ */
+
+#ifndef ROTATION_H
+#define ROTATION_H
+
+// =============================================================================
+// Rotation State
+// =============================================================================
+
+// Rotation shows a project by locking it: updates for the shown project
+// render as usual, others wait in their snapshot (see admitStatusUpdate())
+ProjectId rotationShownId = PROJECT_NONE;
+unsigned long rotationDwellStart = 0;
+
+// When each project was last shown (hash detects an ID reused after eviction)
+unsigned long rotationShownAt[MAX_PROJECTS];
+uint32_t rotationShownHash[MAX_PROJECTS];
+
+// Next screen, composed in stages (one per loop() pass)
+enum ComposeStage { COMPOSE_NONE, COMPOSE_CHARACTER, COMPOSE_STATUS, COMPOSE_INFO, COMPOSE_READY };
+ComposeStage rotationStage = COMPOSE_NONE;
+TFT_eSprite rotationFrame(&tft);
+bool rotationFrameReady = false;  // Full-screen sprite buffer allocated
+
+// What the composed frame shows (the frame is stale if any of this changed)
+struct RotationComposed {
+  ProjectId id;
+  uint32_t nameHash;
+  uint32_t textHash;    // Tool and model
+  AppState state;
+  int8_t memory;
+  const CharacterGeometry* character;
+};
+RotationComposed rotationNext = { PROJECT_NONE, 0, 0, STATE_IDLE, 0, nullptr };
+
+// Rotation counters (metrics)
+uint32_t rotationSwitches = 0;
+uint32_t rotationPrecomposed = 0;  // Switches done with a single frame push
+
+// =============================================================================
+// Scheduling
+// =============================================================================
+
+// State a project is shown in (see showProjectSnapshot())
+AppState getRotationState(const ProjectSnapshot& snapshot) {
+  if (snapshot.state < 0) return STATE_IDLE;
+  unsigned long since = snapshot.updatedAt;
+  return applyStateTimeouts((AppState)snapshot.state, since, millis());
+}
+
+bool isRotationCandidate(ProjectId id, unsigned long now) {
+  const ProjectSnapshot& snapshot = projectTable[id].snapshot;
+  return snapshot.state >= 0 && now - snapshot.updatedAt < ROTATION_ACTIVE_MS;
+}
+
+// Higher is sooner: time waited since last shown, plus a head start by
+// state, minus half the time since the last update
+long getRotationScore(ProjectId id, unsigned long now) {
+  const ProjectEntry& entry = projectTable[id];
+  unsigned long waited = ROTATION_ACTIVE_MS;  // Never shown
+  if (rotationShownHash[id] == entry.hash && now - rotationShownAt[id] < ROTATION_ACTIVE_MS) {
+    waited = now - rotationShownAt[id];
+  }
+
+  AppState state = getRotationState(entry.snapshot);
+  long bonus = 0;
+  if (state == STATE_ALERT || state == STATE_NOTIFICATION) {
+    bonus = ROTATION_URGENT_BONUS_MS;
+  } else if (isActiveState(state)) {
+    bonus = ROTATION_ACTIVE_BONUS_MS;
+  }
+  return (long)waited + bonus - (long)((now - entry.snapshot.updatedAt) / 2);
+}
+
+// Next project to show (PROJECT_NONE: no other active project)
+ProjectId pickRotationProject(unsigned long now) {
+  ProjectId best = PROJECT_NONE;
+  long bestScore = 0;
+  for (int i = 0; i < projectCount; i++) {
+    ProjectId id = (ProjectId)i;
+    if (id == rotationShownId || !isRotationCandidate(id, now)) continue;
+    long score = getRotationScore(id, now);
+    if (best == PROJECT_NONE || score > bestScore) {
+      best = id;
+      bestScore = score;
+    }
+  }
+  return best;
+}
+
+void markRotationShown(ProjectId id, unsigned long now) {
+  rotationShownAt[id] = now;
+  rotationShownHash[id] = projectTable[id].hash;
+}
+
+// =============================================================================
+// Off-screen Composition
+// =============================================================================
+
+// Describe what project `id` would show right now
+RotationComposed describeRotationScreen(ProjectId id) {
+  const ProjectSnapshot& snapshot = projectTable[id].snapshot;
+  RotationComposed screen;
+  screen.id = id;
+  screen.nameHash = projectTable[id].hash;
+  screen.textHash = fnv1a(snapshot.model, fnv1a(snapshot.tool));
+  screen.state = getRotationState(snapshot);
+  screen.memory = snapshot.memory >= 0 ? snapshot.memory : 0;
+  screen.character = getCharacterByName(strlen(snapshot.character) > 0 ? snapshot.character : currentCharacter);
+  return screen;
+}
+
+bool isSameRotationScreen(const RotationComposed& a, const RotationComposed& b) {
+  return a.id == b.id && a.nameHash == b.nameHash && a.textHash == b.textHash &&
+         a.state == b.state && a.memory == b.memory && a.character == b.character;
+}
+
+// Draw one stage of the next screen into rotationFrame. The layout matches
+// drawStatus() with the character at its base position.
+void composeRotationStage() {
+  const ProjectSnapshot& snapshot = projectTable[rotationNext.id].snapshot;
+  AppState state = rotationNext.state;
+  uint16_t bgColor = getBackgroundColorEnum(state);
+  uint16_t textColor = getTextColorEnum(state);
+
+  switch (rotationStage) {
+    case COMPOSE_CHARACTER:
+      rotationFrame.fillSprite(bgColor);
+      drawCharacterToSprite(charSprite, getEyeTypeEnum(state), getEffectTypeEnum(state), bgColor, rotationNext.character);
+      charSprite.pushSprite(&rotationFrame, CHAR_X_BASE, CHAR_Y_BASE);
+      rotationStage = COMPOSE_STATUS;
+      break;
+    case COMPOSE_STATUS:
+      drawStatusText(rotationFrame, state, snapshot.tool, textColor);
+      rotationStage = COMPOSE_INFO;
+      break;
+    case COMPOSE_INFO:
+      drawInfoRows(rotationFrame, state, getProjectName(rotationNext.id), snapshot.tool, snapshot.model,
+                   rotationNext.memory, textColor, bgColor);
+      rotationStage = COMPOSE_READY;
+      break;
+    default:
+      break;
+  }
+}
+
+void startRotationCompose(ProjectId id) {
+  rotationNext = describeRotationScreen(id);
+  rotationStage = COMPOSE_CHARACTER;
+}
+
+// =============================================================================
+// Switching
+// =============================================================================
+
+// Show a project. With a fresh composed frame this is one full-screen push
+// instead of drawStatus()'s fillScreen() and section redraws.
+void switchRotationProject(ProjectId id, unsigned long now) {
+  bool precomposed = rotationStage == COMPOSE_READY &&
+                     isSameRotationScreen(rotationNext, describeRotationScreen(id));
+
+  lockedProjectId = id;
+  showProjectSnapshot(id);  // Sets dirty flags: full redraw unless the frame is pushed
+
+  if (precomposed) {
+    tft.setBrightness(currentState == STATE_SLEEP ? BACKLIGHT_SLEEP : BACKLIGHT_NORMAL);
+    TRACE_BEGIN(TRACE_PUSH_SPRITE, TRACE_PUSH_FRAME);
+    rotationFrame.pushSprite(0, 0);
+    TRACE_END(TRACE_PUSH_SPRITE, TRACE_PUSH_FRAME);
+    lastCharX = CHAR_X_BASE;
+    lastCharY = CHAR_Y_BASE;
+    needsRedraw = false;
+    dirtyCharacter = false;
+    dirtyStatus = false;
+    dirtyInfo = false;
+    drawConnectionIndicator();
+    rotationPrecomposed++;
+  }
+
+  rotationShownId = id;
+  rotationDwellStart = now;
+  rotationStage = COMPOSE_NONE;
+  markRotationShown(id, now);
+  rotationSwitches++;
+}
+
+// Called from loop() in rotation mode, after the status queue is applied and
+// before rendering
+void updateRotation() {
+  unsigned long now = millis();
+
+  // Lock changed outside rotation: a manual lock gets a full dwell, an
+  // unlock moves on right away
+  if (lockedProjectId != rotationShownId) {
+    rotationShownId = lockedProjectId;
+    rotationStage = COMPOSE_NONE;
+    if (rotationShownId != PROJECT_NONE) {
+      rotationDwellStart = now;
+      markRotationShown(rotationShownId, now);
+    } else {
+      rotationDwellStart = now - ROTATION_DWELL_MS;
+    }
+  }
+
+  unsigned long elapsed = now - rotationDwellStart;
+  if (elapsed < ROTATION_DWELL_MS - ROTATION_PRECOMPOSE_MS) return;
+
+  // Compose the next screen before the dwell ends
+  if (rotationFrameReady) {
+    if (rotationStage == COMPOSE_NONE) {
+      ProjectId next = pickRotationProject(now);
+      if (next != PROJECT_NONE) startRotationCompose(next);
+    }
+    if (rotationStage != COMPOSE_NONE && rotationStage != COMPOSE_READY) {
+      composeRotationStage();
+      return;
+    }
+  }
+
+  if (elapsed < ROTATION_DWELL_MS) return;
+
+  // Pick again at the switch: an alert that arrived meanwhile goes first
+  ProjectId next = pickRotationProject(now);
+  if (next == PROJECT_NONE) {
+    // Nothing else to show: keep the current project for another dwell
+    rotationDwellStart = now;
+    rotationStage = COMPOSE_NONE;
+    return;
+  }
+
+  // Frame for another project or out of date: compose again once (switching
+  // a few passes later), then fall back to a full redraw
+  bool stale = rotationStage != COMPOSE_READY ||
+               !isSameRotationScreen(rotationNext, describeRotationScreen(next));
+  if (rotationFrameReady && stale && elapsed < ROTATION_DWELL_MS + ROTATION_PRECOMPOSE_MS) {
+    startRotationCompose(next);
+    composeRotationStage();
+    return;
+  }
+
+  switchRotationProject(next, now);
+}
+
+// Allocate the frame sprite on entry and free it on exit (~110KB). Without it
+// rotation still works, switching with a full redraw.
+void setRotationActive(bool active) {
+  if (active && !rotationFrameReady && spriteInitialized) {
+    rotationFrame.setColorDepth(16);
+    rotationFrameReady = (rotationFrame.createSprite(SCREEN_WIDTH, SCREEN_HEIGHT) != nullptr);
+    if (!rotationFrameReady) {
+      Serial.println("{\"rotation\":\"no-precompose\",\"error\":\"memory\"}");
+    }
+  } else if (!active && rotationFrameReady) {
+    rotationFrame.deleteSprite();
+    rotationFrameReady = false;
+  }
+  rotationStage = COMPOSE_NONE;
+  rotationShownId = PROJECT_NONE;  // updateRotation() adopts the current lock, if any
+  rotationDwellStart = millis() - ROTATION_DWELL_MS;  // Otherwise switch right away
+}
+
+#endif // ROTATION_H
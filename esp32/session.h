@@ -0,0 +1,223 @@
+/*
+ * VibeMon Session
+ * Checksummed snapshot of the lock, screen and recent projects, restored at
+ * boot: from RTC memory after a soft reset, from NVS after power loss
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#if SESSION_PROJECTS < 1 || SESSION_PROJECTS > MAX_PROJECTS
+#error "SESSION_PROJECTS must be 1-MAX_PROJECTS"
+#endif
+
+// =============================================================================
+// Session Record
+// =============================================================================
+
+#define SESSION_MAGIC 0x564D5331UL  // "VMS1": change when SessionRecord changes
+
+struct SessionProject {
+  char name[32];
+  char tool[32];
+  char model[32];
+  char character[16];
+  int8_t state;   // AppState, or -1 if no state received yet
+  int8_t memory;  // 0-100, or -1 if not received
+};
+
+struct SessionRecord {
+  uint32_t magic;
+  uint16_t size;          // sizeof(SessionRecord)
+  uint8_t projectCount;
+  uint8_t lockedIndex;    // Index into projects[], 0xFF = unlocked
+  SessionProject screen;  // What the single-project screen shows
+  SessionProject projects[SESSION_PROJECTS];  // Most recently used first
+  uint32_t crc;           // CRC-32 of all fields above
+};
+
+// Survives ESP.restart(), panics and watchdog resets (not power loss).
+// Contents are random after power-on: always validate before use.
+RTC_NOINIT_ATTR SessionRecord rtcSession;
+
+SessionRecord sessionScratch;  // Built here and compared before touching the RTC copy
+unsigned long sessionLastCheck = 0;
+
+// NVS copy state (written from loop(), debounced)
+bool sessionNvsDirty = false;
+unsigned long sessionFirstChange = 0;  // Oldest change not yet in NVS
+unsigned long sessionLastChange = 0;
+unsigned long sessionNvsWrittenAt = 0;
+uint32_t sessionNvsWrites = 0;
+
+uint32_t getSessionCrc(const SessionRecord& record) {
+  return crc32Update(0, &record, offsetof(SessionRecord, crc));
+}
+
+bool isValidSession(const SessionRecord& record) {
+  return record.magic == SESSION_MAGIC && record.size == sizeof(SessionRecord) &&
+         record.projectCount <= SESSION_PROJECTS &&
+         (record.lockedIndex == 0xFF || record.lockedIndex < record.projectCount) &&
+         record.crc == getSessionCrc(record);
+}
+
+// =============================================================================
+// Save
+// =============================================================================
+
+void fillSessionProject(SessionProject& dst, const char* name, const ProjectSnapshot& snapshot) {
+  safeCopyStr(dst.name, name);
+  safeCopyStr(dst.tool, snapshot.tool);
+  safeCopyStr(dst.model, snapshot.model);
+  safeCopyStr(dst.character, snapshot.character);
+  dst.state = snapshot.state;
+  dst.memory = snapshot.memory;
+}
+
+// Build the record from the current state. Zero-filled first so padding and
+// unused bytes are stable for the CRC.
+void buildSession(SessionRecord& record) {
+  memset(&record, 0, sizeof(record));
+  record.magic = SESSION_MAGIC;
+  record.size = sizeof(SessionRecord);
+  record.lockedIndex = 0xFF;
+
+  safeCopyStr(record.screen.name, currentProject);
+  safeCopyStr(record.screen.tool, currentTool);
+  safeCopyStr(record.screen.model, currentModel);
+  safeCopyStr(record.screen.character, currentCharacter);
+  record.screen.state = currentState;
+  record.screen.memory = currentMemory;
+
+  // Most recently used projects; the locked one is always kept
+  for (ProjectId id = projectLruHead; id != PROJECT_NONE && record.projectCount < SESSION_PROJECTS;
+       id = projectTable[id].lruNext) {
+    if (id == lockedProjectId) record.lockedIndex = record.projectCount;
+    fillSessionProject(record.projects[record.projectCount++], projectTable[id].name, projectTable[id].snapshot);
+  }
+  if (lockedProjectId != PROJECT_NONE && record.lockedIndex == 0xFF) {
+    record.lockedIndex = record.projectCount - 1;
+    fillSessionProject(record.projects[record.lockedIndex], getLockedProject(), projectTable[lockedProjectId].snapshot);
+  }
+
+  record.crc = getSessionCrc(record);
+}
+
+// Update the RTC copy if anything changed; changes are queued for NVS
+void saveSessionRtc() {
+  buildSession(sessionScratch);
+  if (rtcSession.magic == SESSION_MAGIC && rtcSession.crc == sessionScratch.crc) return;
+
+  rtcSession = sessionScratch;
+  unsigned long now = millis();
+  if (!sessionNvsDirty) sessionFirstChange = now;
+  sessionLastChange = now;
+  sessionNvsDirty = true;
+}
+
+void writeSessionNvs() {
+  preferences.begin("vibemon", false);
+  preferences.putBytes("session", &rtcSession, sizeof(rtcSession));
+  preferences.end();
+  sessionNvsDirty = false;
+  sessionNvsWrittenAt = millis();
+  sessionNvsWrites++;
+}
+
+// Called from loop(): RTC copy at most every SESSION_RTC_INTERVAL_MS; NVS once
+// changes settle (batched, rate limited for flash wear)
+void updateSession() {
+  unsigned long now = millis();
+  if (now - sessionLastCheck < SESSION_RTC_INTERVAL_MS) return;
+  sessionLastCheck = now;
+
+  saveSessionRtc();
+  if (!sessionNvsDirty) return;
+
+  bool settled = now - sessionLastChange >= SESSION_NVS_QUIET_MS;
+  bool overdue = now - sessionFirstChange >= SESSION_NVS_MAX_DELAY_MS;
+  if ((settled || overdue) && now - sessionNvsWrittenAt >= SESSION_NVS_MIN_INTERVAL_MS) {
+    writeSessionNvs();
+  }
+}
+
+// Called right before a planned restart (reboot, WiFi reset/setup): writes
+// pending settings and the session
+void persistBeforeRestart() {
+  flushSettings();
+  saveSessionRtc();
+  if (sessionNvsDirty) writeSessionNvs();
+}
+
+// =============================================================================
+// Restore
+// =============================================================================
+
+bool isValidSessionState(int8_t state) {
+  return state >= -1 && state <= STATE_ALERT;
+}
+
+// Restore the saved session (called from setup() after resetProjectTable(),
+// before the first frame). Returns false if there is nothing to restore.
+// Timeouts start over from boot.
+bool restoreSession() {
+  const char* source = "rtc";
+  if (isValidSession(rtcSession)) {
+    sessionScratch = rtcSession;
+  } else {
+    source = "nvs";
+    preferences.begin("vibemon", true);
+    size_t len = preferences.getBytes("session", &sessionScratch, sizeof(sessionScratch));
+    preferences.end();
+    if (len != sizeof(sessionScratch) || !isValidSession(sessionScratch)) return false;
+    rtcSession = sessionScratch;
+  }
+
+  const SessionRecord& record = sessionScratch;
+  if (record.projectCount == 0 && record.screen.state == STATE_START) return false;
+  unsigned long now = millis();
+
+  // Oldest first, so the most recently used project ends up at the LRU head
+  for (int i = record.projectCount - 1; i >= 0; i--) {
+    const SessionProject& saved = record.projects[i];
+    ProjectId id = internProject(saved.name);
+    if (id == PROJECT_NONE) continue;
+    ProjectSnapshot& snapshot = projectTable[id].snapshot;
+    safeCopyStr(snapshot.tool, saved.tool);
+    safeCopyStr(snapshot.model, saved.model);
+    if (isValidCharacter(saved.character)) safeCopyStr(snapshot.character, saved.character);
+    snapshot.state = isValidSessionState(saved.state) ? saved.state : -1;
+    snapshot.memory = saved.memory;
+    snapshot.updatedAt = now;
+    if (i == record.lockedIndex) lockedProjectId = id;
+  }
+
+  // Screen
+  safeCopyStr(currentProject, record.screen.name);
+  safeCopyStr(currentTool, record.screen.tool);
+  safeCopyStr(currentModel, record.screen.model);
+  if (isValidCharacter(record.screen.character)) safeCopyStr(currentCharacter, record.screen.character);
+  currentState = isValidSessionState(record.screen.state) && record.screen.state >= 0
+                 ? (AppState)record.screen.state : STATE_IDLE;
+  currentMemory = record.screen.memory;
+  lastActivityTime = now;
+  needsRedraw = true;
+  dirtyCharacter = true;
+  dirtyStatus = true;
+  dirtyInfo = true;
+
+  Serial.print("{\"session\":\"restored\",\"source\":\"");
+  Serial.print(source);
+  Serial.print("\",\"projects\":");
+  Serial.print(projectCount);
+  Serial.print(",\"lockedProject\":");
+  if (lockedProjectId != PROJECT_NONE) {
+    jsonPrintString(Serial, getLockedProject());
+    Serial.println("}");
+  } else {
+    Serial.println("null}");
+  }
+  return true;
+}
+
+#endif // SESSION_H
@@ -0,0 +1,198 @@
+/*
+ * VibeMon Settings
+ * Persistent settings as one versioned, CRC-checked blob cached in RAM.
+ * Setters only update the cache; loop() flushes changes to NVS.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+// =============================================================================
+// Settings Record
+// =============================================================================
+
+#define SETTINGS_VERSION 2  // Bump when Settings changes (and migrate in loadSettings())
+
+// Same layout with or without USE_WIFI, so switching builds keeps credentials
+struct Settings {
+  uint16_t version;
+  uint16_t size;          // sizeof(Settings)
+  int8_t lockMode;        // LOCK_MODE_*
+  int8_t viewMode;        // VIEW_MODE_*
+  char wifiSSID[64];
+  char wifiPassword[64];
+  char wsToken[128];
+  // Last successful WiFi connection, tried first on boot (wifiChannel 0 = none)
+  uint8_t wifiBssid[6];
+  uint8_t wifiChannel;
+  uint32_t wifiIP;
+  uint32_t wifiGateway;
+  uint32_t wifiSubnet;
+  uint32_t wifiDns;
+  uint32_t crc;           // CRC-32 of all fields above
+};
+
+// Version 1 layout (before the WiFi connection cache), migrated on load
+struct SettingsV1 {
+  uint16_t version;
+  uint16_t size;
+  int8_t lockMode;
+  int8_t viewMode;
+  char wifiSSID[64];
+  char wifiPassword[64];
+  char wsToken[128];
+  uint32_t crc;
+};
+
+Settings settings;  // RAM cache (source of truth after loadSettings())
+
+bool settingsDirty = false;
+unsigned long settingsChangedAt = 0;   // Last change not yet in NVS
+unsigned long settingsWrittenAt = 0;
+uint32_t settingsWrittenCrc = 0;       // CRC of the NVS copy
+uint32_t settingsWrites = 0;
+
+uint32_t getSettingsCrc(const Settings& s) {
+  return crc32Update(0, &s, offsetof(Settings, crc));
+}
+
+bool isValidSettings(const Settings& s) {
+  return s.version == SETTINGS_VERSION && s.size == sizeof(Settings) && s.crc == getSettingsCrc(s);
+}
+
+bool isValidSettingsV1(const SettingsV1& s) {
+  return s.version == 1 && s.size == sizeof(SettingsV1) && s.crc == crc32Update(0, &s, offsetof(SettingsV1, crc));
+}
+
+// Zero-filled so padding and unused bytes are stable for the CRC
+void resetSettings(Settings& s) {
+  memset(&s, 0, sizeof(s));
+  s.version = SETTINGS_VERSION;
+  s.size = sizeof(Settings);
+  s.lockMode = LOCK_MODE_ON_THINKING;
+  s.viewMode = VIEW_MODE_SINGLE;
+}
+
+// =============================================================================
+// Flush
+// =============================================================================
+
+// Record a change to the cache (never touches flash)
+void markSettingsDirty() {
+  settingsDirty = true;
+  settingsChangedAt = millis();
+}
+
+// Returns false if the blob could not be written (NVS full or failing)
+bool writeSettings() {
+  settings.crc = getSettingsCrc(settings);
+  settingsDirty = false;
+  if (settings.crc == settingsWrittenCrc) return true;  // Changed back: nothing to write
+
+  preferences.begin("vibemon", false);
+  bool written = preferences.putBytes("settings", &settings, sizeof(settings)) == sizeof(settings);
+  preferences.end();
+  settingsWrittenAt = millis();
+  settingsWrites++;
+  if (!written) {
+    markSettingsDirty();  // Retried from loop()
+    return false;
+  }
+  settingsWrittenCrc = settings.crc;
+  return true;
+}
+
+// Called from loop(): writes coalesced changes once they settle for
+// SETTINGS_FLUSH_DELAY_MS, at most every SETTINGS_MIN_INTERVAL_MS
+void updateSettings() {
+  if (!settingsDirty) return;
+  unsigned long now = millis();
+  if (now - settingsChangedAt < SETTINGS_FLUSH_DELAY_MS) return;
+  if (settingsWrites > 0 && now - settingsWrittenAt < SETTINGS_MIN_INTERVAL_MS) return;
+  writeSettings();
+}
+
+// Write pending changes now (before a planned restart)
+void flushSettings() {
+  if (settingsDirty) writeSettings();
+}
+
+// =============================================================================
+// Load
+// =============================================================================
+
+// Keys of firmware before the settings blob. Each is written only once it
+// differs from the default (the portal writes just the credentials), so
+// any of them means there is something to import.
+const char* const LEGACY_SETTINGS_KEYS[] = { "wifiSSID", "wifiPassword", "wsToken", "lockMode", "viewMode" };
+
+bool hasLegacySettings() {
+  for (const char* key : LEGACY_SETTINGS_KEYS) {
+    if (preferences.isKey(key)) return true;
+  }
+  return false;
+}
+
+// Load settings into the cache (called first in setup()). On the first boot
+// with the settings store, the individual keys of older firmware are
+// imported into the blob and removed. Older blob versions are upgraded.
+void loadSettings() {
+  preferences.begin("vibemon", true);  // Read-only
+  size_t len = preferences.getBytes("settings", &settings, sizeof(settings));
+  bool valid = (len == sizeof(settings) && isValidSettings(settings));
+  SettingsV1 v1;
+  bool upgrade = false;
+  if (!valid && len == sizeof(v1)) {
+    memcpy(&v1, &settings, sizeof(v1));
+    upgrade = isValidSettingsV1(v1);
+  }
+  bool legacy = !valid && !upgrade && hasLegacySettings();
+  if (!valid) {
+    resetSettings(settings);
+    if (upgrade) {
+      settings.lockMode = v1.lockMode;
+      settings.viewMode = v1.viewMode;
+      safeCopyStr(settings.wifiSSID, v1.wifiSSID);
+      safeCopyStr(settings.wifiPassword, v1.wifiPassword);
+      safeCopyStr(settings.wsToken, v1.wsToken);
+    } else if (legacy) {
+      settings.lockMode = preferences.getInt("lockMode", LOCK_MODE_ON_THINKING);
+      settings.viewMode = preferences.getInt("viewMode", VIEW_MODE_SINGLE);
+      preferences.getString("wifiSSID", settings.wifiSSID, sizeof(settings.wifiSSID));
+      preferences.getString("wifiPassword", settings.wifiPassword, sizeof(settings.wifiPassword));
+      preferences.getString("wsToken", settings.wsToken, sizeof(settings.wsToken));
+    }
+  }
+  preferences.end();
+
+  if (valid) {
+    settingsWrittenCrc = settings.crc;
+  }
+
+  // Validate values (flash corruption safety)
+  if (settings.lockMode != LOCK_MODE_FIRST_PROJECT && settings.lockMode != LOCK_MODE_ON_THINKING) {
+    settings.lockMode = LOCK_MODE_ON_THINKING;
+    markSettingsDirty();
+  }
+  if (settings.viewMode != VIEW_MODE_SINGLE && settings.viewMode != VIEW_MODE_DASHBOARD &&
+      settings.viewMode != VIEW_MODE_ROTATION) {
+    settings.viewMode = VIEW_MODE_SINGLE;
+    markSettingsDirty();
+  }
+
+  if (upgrade) {
+    writeSettings();
+    Serial.println("{\"settings\":\"upgraded\",\"from\":1}");
+  }
+
+  // The old keys go only once the blob holds their values (otherwise the
+  // import runs again on the next boot)
+  if (legacy && writeSettings()) {
+    preferences.begin("vibemon", false);
+    for (const char* key : LEGACY_SETTINGS_KEYS) preferences.remove(key);
+    preferences.end();
+    Serial.println("{\"settings\":\"migrated\"}");
+  }
+}
+
+#endif // SETTINGS_H
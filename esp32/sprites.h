@@ -740,7 +740,8 @@ uint16_t getGradientColor(int pos, int width, int percent) {
 
 // Draw memory bar with gradient
 // Optimized: Uses segment-based rendering (8px segments) instead of per-pixel
-void drawMemoryBar(TFT_eSPI &tft, int x, int y, int width, int height, int percent, uint16_t bgColor) {
+template<typename T>
+void drawMemoryBar(T &canvas, int x, int y, int width, int height, int percent, uint16_t bgColor) {
   int clampedPercent = min(100, max(0, percent));
   int fillWidth = (width * clampedPercent) / 100;
 
@@ -750,10 +751,10 @@ void drawMemoryBar(TFT_eSPI &tft, int x, int y, int width, int height, int perce
   uint16_t containerBg = isDarkBg ? 0x3186 : 0x2104;  // Lighter or darker
 
   // Border (1px)
-  tft.drawRect(x, y, width, height, borderColor);
+  canvas.drawRect(x, y, width, height, borderColor);
 
   // Background - inside border
-  tft.fillRect(x + 1, y + 1, width - 2, height - 2, containerBg);
+  canvas.fillRect(x + 1, y + 1, width - 2, height - 2, containerBg);
 
   // Fill bar with gradient using segments (8px each for ~8x speedup)
   if (fillWidth > 2) {
@@ -764,7 +765,7 @@ void drawMemoryBar(TFT_eSPI &tft, int x, int y, int width, int height, int perce
     for (int i = 0; i < innerWidth; i += segmentSize) {
       int segWidth = min(segmentSize, innerWidth - i);
       uint16_t color = getGradientColor(i, innerWidth, clampedPercent);
-      tft.fillRect(x + 1 + i, y + 1, segWidth, barHeight, color);
+      canvas.fillRect(x + 1 + i, y + 1, segWidth, barHeight, color);
     }
   }
 }
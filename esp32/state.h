@@ -40,12 +40,49 @@ bool needsRedraw = true;
 int lastCharX = CHAR_X_BASE;  // Track last character X for efficient redraw
 int lastCharY = CHAR_Y_BASE;  // Track last character Y for efficient redraw
 
-// Project lock
-char projectList[MAX_PROJECTS][32];  // List of incoming projects
+// Project table (see project_lock.h). A ProjectId is the entry's index and
+// stays valid until the project is evicted.
+typedef uint8_t ProjectId;
+#define PROJECT_NONE    0xFF  // No project (empty name / unlocked)
+#define PROJECT_EVICTED 0xFE  // Queued update whose project was evicted
+
+#if MAX_PROJECTS < 2 || MAX_PROJECTS > 254
+#error "MAX_PROJECTS must be 2-254 (one slot is pinned by the lock, IDs are uint8_t)"
+#endif
+
+// Last-known status of a project, kept for every project in the table
+// (blocked ones included) so a lock switch can show it immediately
+struct ProjectSnapshot {
+  int8_t state;             // AppState, or -1 if no state received yet
+  int8_t memory;            // 0-100, or -1 if not received
+  char tool[32];
+  char model[32];
+  char character[16];       // "" if not received
+  unsigned long updatedAt;  // millis() of the last update
+};
+
+struct ProjectEntry {
+  char name[32];
+  uint32_t hash;
+  ProjectId nextInBucket;  // Hash chain
+  ProjectId lruPrev;       // Towards most recently used
+  ProjectId lruNext;       // Towards least recently used
+  ProjectSnapshot snapshot;
+};
+
+ProjectEntry projectTable[MAX_PROJECTS];
+ProjectId projectBuckets[PROJECT_HASH_BUCKETS];
+ProjectId projectLruHead = PROJECT_NONE;  // Most recently used
+ProjectId projectLruTail = PROJECT_NONE;  // Eviction candidate
 int projectCount = 0;
-char lockedProject[32] = "";  // Locked project name (empty = unlocked)
+
+// Project lock
+ProjectId lockedProjectId = PROJECT_NONE;  // PROJECT_NONE = unlocked
 int lockMode = LOCK_MODE_ON_THINKING;  // Default: on-thinking
 
+// Screen layout (see dashboard.h)
+int viewMode = VIEW_MODE_SINGLE;  // Default: single project
+
 // Dirty rect tracking for efficient redraws
 bool dirtyCharacter = true;
 bool dirtyStatus = true;
@@ -54,6 +91,31 @@ bool dirtyInfo = true;
 // State timeouts
 unsigned long lastActivityTime = 0;
 
+// Input transports (used for per-transport counters)
+enum InputSource {
+  INPUT_SERIAL,
+  INPUT_HTTP,
+  INPUT_WEBSOCKET,
+  INPUT_UDP,
+  INPUT_WEBSOCKET_LAN,  // Clients of the device's own WebSocket server
+  INPUT_SOURCE_COUNT
+};
+
+// Outcome of processInput()
+enum InputResult {
+  INPUT_APPLIED,    // Command handled or status applied
+  INPUT_BLOCKED,    // Status from a non-locked project
+  INPUT_DUPLICATE,  // Same event already applied via another transport
+  INPUT_INVALID,    // JSON parse error or unusable payload
+  INPUT_THROTTLED,  // Source over its rate limit, update dropped
+  INPUT_COALESCED,  // Over the rate limit, merged into its project's queued update
+  INPUT_BATCH       // Array payload: per-item results in batchResults[]
+};
+
+// Where command replies are printed: Serial, or the LAN WebSocket client
+// whose message is being processed (ws_server.h)
+Print* commandReply = &Serial;
+
 // Serial input buffer (avoid String allocation)
 char serialBuffer[512];
 int serialBufferPos = 0;
@@ -79,15 +141,18 @@ const char* defaultSSID = "";
 const char* defaultPassword = "";
 #endif
 
-WebServer server(80);
+WebServer server(80);  // Provisioning portal (status API: http_server.h)
 
 const unsigned long WIFI_CHECK_INTERVAL = 10000;  // Check every 10 seconds
 unsigned long lastWifiCheck = 0;
 bool wifiWasConnected = false;
+unsigned long wifiConnectMs = 0;  // Boot to first connection (0 = not connected yet)
+bool wifiFastConnect = false;     // First connection used the cached access point
 
 #ifdef USE_WEBSOCKET
 WebSocketsClient webSocket;
 bool wsConnected = false;
+uint32_t wsConnectionId = 0;  // Incremented per connection (rate limit source ID)
 
 char wsToken[128] = "";
 
@@ -98,7 +163,9 @@ const char* defaultWSToken = WS_TOKEN;
 const char* defaultWSToken = "";
 #endif
 
-// Exponential backoff for reconnection (server-friendly)
+// Exponential backoff for reconnection (server-friendly). Starts from twice
+// the measured RTO within MIN..INITIAL, jittered (ws_health.h).
+const unsigned long WS_RECONNECT_MIN = 1000;       // 1 second
 const unsigned long WS_RECONNECT_INITIAL = 5000;   // 5 seconds
 const unsigned long WS_RECONNECT_MAX = 15000;       // 15 seconds (reduced from 60s)
 const unsigned long WS_RECONNECT_BACKOFF = 300000;  // 5 minutes (after max failures)
@@ -114,10 +181,17 @@ uint8_t wsConsecutiveFailures = 0;
 unsigned long wsDisconnectedSince = 0;
 const unsigned long WS_REINIT_TIMEOUT = 120000;  // Force reinit if disconnected >120s
 
-// Heartbeat to detect stale connections (relaxed for modem sleep compatibility)
-const unsigned long WS_HEARTBEAT_INTERVAL = 30000;  // Ping every 30s
-const unsigned long WS_HEARTBEAT_TIMEOUT = 10000;   // Pong timeout 10s (modem sleep adds 100-300ms)
-const uint8_t WS_HEARTBEAT_FAILURES = 2;            // Disconnect after 2 missed
+// Heartbeat to detect stale connections, adapted to the measured link
+// (ws_health.h): pong timeout from the ping RTT, ping after a silence of a
+// few timeouts. The bounds keep modem sleep (100-300ms extra per exchange)
+// from causing false disconnects.
+const unsigned long WS_RTO_INITIAL = 10000;      // Pong timeout before the first RTT sample
+const unsigned long WS_RTO_MIN = 1500;
+const unsigned long WS_RTO_MAX = 20000;
+const unsigned long WS_PING_IDLE_MIN = 5000;     // Ping after this much silence at least...
+const unsigned long WS_PING_IDLE_MAX = 30000;    // ...and at most
+const uint8_t WS_PING_IDLE_RTO_FACTOR = 6;
+const uint8_t WS_HEARTBEAT_FAILURES = 2;         // Disconnect after 2 missed pongs
 #endif
 #endif
 
@@ -157,6 +231,43 @@ const char* getStateString(AppState state) {
   }
 }
 
+// FNV-1a hash (32-bit), chainable via seed
+uint32_t fnv1a(const char* str, uint32_t hash = 2166136261UL) {
+  while (*str) {
+    hash ^= (uint8_t)*str++;
+    hash *= 16777619UL;
+  }
+  // Field separator so "ab"+"c" and "a"+"bc" differ
+  hash ^= 0x1F;
+  hash *= 16777619UL;
+  return hash;
+}
+
+// CRC-32 (IEEE 802.3, as zlib), chainable via crc
+uint32_t crc32Update(uint32_t crc, const void* data, size_t len) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  crc = ~crc;
+  while (len--) {
+    crc ^= *bytes++;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+// Helper: Get transport name (for JSON output)
+const char* getInputSourceString(InputSource source) {
+  switch (source) {
+    case INPUT_SERIAL: return "serial";
+    case INPUT_HTTP: return "http";
+    case INPUT_WEBSOCKET: return "websocket";
+    case INPUT_UDP: return "udp";
+    case INPUT_WEBSOCKET_LAN: return "websocket-lan";
+    default: return "unknown";
+  }
+}
+
 // Helper: True for states that show slow loading dots (thought bubble)
 bool isLoadingState(AppState state) {
   return state == STATE_THINKING || state == STATE_PLANNING || state == STATE_PACKING;
@@ -175,15 +286,20 @@ int getLoopDelay() {
   return LOOP_DELAY_IDLE;
 }
 
+// Forward declaration (defined in history.h)
+void recordScreenHistory(AppState state);
+
 // State transition: updates state variables and sets dirty flags.
 // Rendering is handled centrally in loop() via drawStatus().
 void transitionToState(AppState newState, bool resetTimer = true) {
   previousState = currentState;
   currentState = newState;
   if (resetTimer) lastActivityTime = millis();
+  recordScreenHistory(newState);
   needsRedraw = true;
   dirtyCharacter = true;
   dirtyStatus = true;
+  TRACE_INSTANT(TRACE_DIRTY, TRACE_DIRTY_BITS());
 }
 
 // Check state timeouts for auto-transitions
@@ -217,4 +333,21 @@ void checkSleepTimer() {
   }
 }
 
+// State a project reaches when checkSleepTimer() has run since `since`
+// (used for projects that are not on screen). Advances `since` like
+// transitionToState() resets the timer.
+AppState applyStateTimeouts(AppState state, unsigned long& since, unsigned long now) {
+  if ((state == STATE_START || state == STATE_DONE) && now - since >= IDLE_TIMEOUT) {
+    state = STATE_IDLE;
+    since += IDLE_TIMEOUT;
+  } else if (isActiveState(state) && now - since >= SLEEP_TIMEOUT) {
+    state = STATE_IDLE;
+    since += SLEEP_TIMEOUT;
+  }
+  if (state == STATE_IDLE && now - since >= SLEEP_TIMEOUT) {
+    state = STATE_SLEEP;  // Timer not reset (see checkSleepTimer())
+  }
+  return state;
+}
+
 #endif // STATE_H
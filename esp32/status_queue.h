@@ -0,0 +1,187 @@
+/*
+ * VibeMon Status Queue
+ * Two-lane input pipeline: control commands run immediately,
+ * status updates go through a bounded, coalescing queue
+ */
+
+#ifndef STATUS_QUEUE_H
+#define STATUS_QUEUE_H
+
+// =============================================================================
+// Status Update Record
+// =============================================================================
+
+// Compact, parsed form of a status object (fields absent in the JSON are empty / -1)
+struct StatusUpdate {
+  int8_t state;              // AppState, or -1 if not provided
+  int8_t memory;             // 0-100, or -1 if not provided
+  char project[32];
+  ProjectId projectId;       // Set on admission (internProject())
+  char tool[32];
+  char model[32];
+  char character[16];        // Only set when isValidCharacter()
+  unsigned long receivedUs;  // micros() when the first coalesced copy arrived
+  LatencyProbe probe;        // probe.id 0 if the sender did not ask for timing
+};
+
+// Parse status JSON into a StatusUpdate (no state is modified)
+void parseStatusUpdate(JsonObject doc, StatusUpdate& update) {
+  const char* stateStr = doc["state"] | "";
+  update.state = strlen(stateStr) > 0 ? (int8_t)parseState(stateStr) : -1;
+
+  int memoryVal = doc["memory"] | -1;
+  update.memory = (memoryVal >= 0 && memoryVal <= 100) ? (int8_t)memoryVal : -1;
+
+  safeCopyStr(update.project, doc["project"] | "");
+  update.projectId = PROJECT_NONE;
+  safeCopyStr(update.tool, doc["tool"] | "");
+  safeCopyStr(update.model, doc["model"] | "");
+
+  const char* charInput = doc["character"] | "";
+  if (isValidCharacter(charInput)) {
+    safeCopyStr(update.character, charInput);
+  } else {
+    update.character[0] = '\0';
+  }
+
+  update.probe.id = (uint32_t)(doc["probe"] | 0UL);
+  update.probe.ts = (uint32_t)(doc["ts"] | 0UL);
+}
+
+// =============================================================================
+// Lane Latency Metrics
+// =============================================================================
+
+enum InputLane { LANE_CONTROL, LANE_STATUS, LANE_COUNT };
+
+// Receive-to-done latency per lane (micros)
+struct LaneStats {
+  uint32_t count;
+  uint64_t totalUs;
+  uint32_t maxUs;
+};
+
+LaneStats laneStats[LANE_COUNT] = {};
+
+// micros() when the input currently being processed arrived, its transport,
+// and which source sent it (remote IP / connection ID; set by processInput)
+unsigned long inputReceivedUs = 0;
+InputSource inputSource = INPUT_SERIAL;
+uint32_t inputSourceId = 0;
+
+void recordLaneLatency(InputLane lane, unsigned long startUs) {
+  uint32_t elapsed = (uint32_t)(micros() - startUs);
+  LaneStats& stats = laneStats[lane];
+  stats.count++;
+  stats.totalUs += elapsed;
+  if (elapsed > stats.maxUs) stats.maxUs = elapsed;
+}
+
+uint32_t getLaneAvgUs(InputLane lane) {
+  const LaneStats& stats = laneStats[lane];
+  return stats.count > 0 ? (uint32_t)(stats.totalUs / stats.count) : 0;
+}
+
+// =============================================================================
+// Coalescing Queue
+// =============================================================================
+
+StatusUpdate statusQueue[STATUS_QUEUE_SIZE];
+uint8_t statusQueueHead = 0;
+uint8_t statusQueueLen = 0;
+uint32_t statusCoalesced = 0;   // Updates merged into a queued entry
+uint32_t statusDropped = 0;     // Queued updates discarded (lock moved away, project evicted)
+
+// Forward declaration (defined in input.h)
+void applyStatusUpdate(const StatusUpdate& update);
+
+// Merge a newer update into a queued one (or a ProjectSnapshot) so the result
+// matches applying both in order. A state change clears the tool (same rule as
+// apply); baseState is what the state is compared to if queued carries none.
+template <typename T>
+void mergeStatusUpdate(T& queued, const StatusUpdate& update, int8_t baseState) {
+  if (update.state >= 0) {
+    int8_t before = queued.state >= 0 ? queued.state : baseState;
+    if (update.state != before) queued.tool[0] = '\0';
+    queued.state = update.state;
+  }
+  if (update.memory >= 0) queued.memory = update.memory;
+  if (strlen(update.tool) > 0) safeCopyStr(queued.tool, update.tool);
+  if (strlen(update.model) > 0) safeCopyStr(queued.model, update.model);
+  if (strlen(update.character) > 0) safeCopyStr(queued.character, update.character);
+}
+
+// Apply the oldest queued update
+void applyQueueHead() {
+  StatusUpdate& head = statusQueue[statusQueueHead];
+  // Re-check lock: a control command may have locked another project meanwhile
+  if (head.projectId == PROJECT_EVICTED || isLockedToDifferentProject(head.projectId)) {
+    statusDropped++;
+    finishProbe(head.probe, PROBE_DROPPED);
+  } else {
+    applyStatusUpdate(head);
+    recordLaneLatency(LANE_STATUS, head.receivedUs);
+    awaitProbeFlush(head.probe);
+  }
+  statusQueueHead = (statusQueueHead + 1) % STATUS_QUEUE_SIZE;
+  statusQueueLen--;
+}
+
+// True if the newest queued update is for this project
+bool isQueueTail(ProjectId id) {
+  if (statusQueueLen == 0) return false;
+  return statusQueue[(statusQueueHead + statusQueueLen - 1) % STATUS_QUEUE_SIZE].projectId == id;
+}
+
+// State the queue tail will be applied on top of: the last state set by an
+// earlier queued update (evicted ones are dropped), or the displayed one
+int8_t getStateBeforeTail() {
+  for (int i = (int)statusQueueLen - 2; i >= 0; i--) {
+    const StatusUpdate& queued = statusQueue[(statusQueueHead + i) % STATUS_QUEUE_SIZE];
+    if (queued.state >= 0 && queued.projectId != PROJECT_EVICTED) return queued.state;
+  }
+  return (int8_t)currentState;
+}
+
+// Merge into the queue tail if it holds the same project (used for updates
+// over their rate limit: they cost no extra apply). Returns false otherwise.
+bool coalesceIntoTail(const StatusUpdate& update) {
+  if (statusQueueLen == 0) return false;
+  StatusUpdate& tail = statusQueue[(statusQueueHead + statusQueueLen - 1) % STATUS_QUEUE_SIZE];
+  if (tail.projectId != update.projectId) return false;
+  mergeStatusUpdate(tail, update, getStateBeforeTail());
+  mergeProbe(tail.probe, update.probe);
+  statusCoalesced++;
+  return true;
+}
+
+// Queue an admitted status update. Only the tail entry is a coalescing
+// candidate (same project), which keeps cross-project ordering intact.
+// When full, the oldest entry is applied to make room (status is never lost).
+void enqueueStatusUpdate(const StatusUpdate& update) {
+  if (coalesceIntoTail(update)) return;
+  if (statusQueueLen >= STATUS_QUEUE_SIZE) {
+    applyQueueHead();
+  }
+  statusQueue[(statusQueueHead + statusQueueLen) % STATUS_QUEUE_SIZE] = update;
+  statusQueueLen++;
+}
+
+// Called when a project is evicted from the table: its ID may be reused, so
+// queued updates for it can no longer be lock-checked and are dropped on apply
+void forgetQueuedProject(ProjectId id) {
+  for (uint8_t i = 0; i < statusQueueLen; i++) {
+    StatusUpdate& queued = statusQueue[(statusQueueHead + i) % STATUS_QUEUE_SIZE];
+    if (queued.projectId == id) queued.projectId = PROJECT_EVICTED;
+  }
+}
+
+// Apply all queued status updates (called once per loop() before rendering,
+// and before control commands that change the lock to preserve ordering)
+void drainStatusQueue() {
+  while (statusQueueLen > 0) {
+    applyQueueHead();
+  }
+}
+
+#endif // STATUS_QUEUE_H
@@ -0,0 +1,57 @@
+/*
+ * VibeMon Status Watch
+ * Sequence-numbered snapshot of the displayed status for clients that watch
+ * it instead of polling GET /status (LAN WebSocket subscribers, long polls,
+ * event streams). Refreshed on demand: the sequence
+ * number advances only when the snapshot actually changed.
+ */
+
+#ifndef STATUS_WATCH_H
+#define STATUS_WATCH_H
+
+// =============================================================================
+// Status Snapshot
+// =============================================================================
+
+uint32_t statusSeq = 0;        // 0 = no snapshot taken yet
+char statusEvent[STATUS_EVENT_SIZE] = "";  // JSON members, no braces
+
+// Displayed status as JSON members (shared by every watcher format). Names
+// come from the network and are escaped.
+void buildStatusEventFields(char* buf, size_t size) {
+  JsonWriter json;
+  jsonBegin(json, buf, size - 1);  // Room for the NUL
+  jsonKey(json, "state");
+  jsonString(json, getStateString(currentState));
+  jsonKey(json, "project");
+  jsonString(json, currentProject);
+  jsonKey(json, "tool");
+  jsonString(json, currentTool);
+  jsonKey(json, "model");
+  jsonString(json, currentModel);
+  jsonKey(json, "memory");
+  jsonInt(json, currentMemory);
+  jsonKey(json, "lockedProject");
+  if (lockedProjectId != PROJECT_NONE) {
+    jsonString(json, getLockedProject());
+  } else {
+    jsonNull(json);
+  }
+  jsonKey(json, "lockMode");
+  jsonString(json, getLockModeString());
+  jsonKey(json, "projectCount");
+  jsonInt(json, projectCount);
+  buf[json.len] = '\0';
+}
+
+// Rebuild the snapshot. Returns true (and advances statusSeq) if it changed.
+bool refreshStatusEvent() {
+  char fields[STATUS_EVENT_SIZE];
+  buildStatusEventFields(fields, sizeof(fields));
+  if (statusSeq > 0 && strcmp(fields, statusEvent) == 0) return false;
+  safeCopyStr(statusEvent, fields);
+  statusSeq++;
+  return true;
+}
+
+#endif // STATUS_WATCH_H
@@ -0,0 +1,123 @@
+/*
+ * VibeMon Trace
+ * Compile-time event tracer (USE_TRACE): fixed-size events with microsecond
+ * timestamps in a lock-free ring, dumped in binary over Serial or GET /trace.
+ * Convert with tools/trace_to_chrome.py. Without USE_TRACE the TRACE_*
+ * macros compile to nothing.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+// Event types (keep in sync with tools/trace_to_chrome.py)
+enum TraceType : uint8_t {
+  TRACE_INPUT = 1,        // Instant: payload arrived (arg: InputSource)
+  TRACE_PROCESS_INPUT,    // Span: processInput() (arg: InputSource)
+  TRACE_DIRTY,            // Instant: dirty flags set (arg: TRACE_DIRTY_* bits)
+  TRACE_DRAW_STATUS,      // Span: drawStatus()
+  TRACE_PUSH_SPRITE,      // Span: sprite pushed to the panel (arg: TRACE_PUSH_*)
+  TRACE_WS_CONNECT,       // Instant: WebSocket connected
+  TRACE_WS_DISCONNECT     // Instant: WebSocket disconnected
+};
+
+#define TRACE_DIRTY_REDRAW    0x01
+#define TRACE_DIRTY_CHARACTER 0x02
+#define TRACE_DIRTY_STATUS    0x04
+#define TRACE_DIRTY_INFO      0x08
+
+// Current dirty flags as TRACE_DIRTY_* bits (expanded where the flags exist)
+#define TRACE_DIRTY_BITS() ((needsRedraw ? TRACE_DIRTY_REDRAW : 0) | (dirtyCharacter ? TRACE_DIRTY_CHARACTER : 0) | \
+                            (dirtyStatus ? TRACE_DIRTY_STATUS : 0) | (dirtyInfo ? TRACE_DIRTY_INFO : 0))
+
+#define TRACE_PUSH_CHARACTER  0  // 128x128 character sprite
+#define TRACE_PUSH_FRAME      1  // Full-screen rotation frame
+
+#ifdef USE_TRACE
+
+#if TRACE_EVENTS < 2 || (TRACE_EVENTS & (TRACE_EVENTS - 1)) != 0
+#error "TRACE_EVENTS must be a power of 2"
+#endif
+
+// One event (8 bytes, little-endian in the dump)
+struct TraceEvent {
+  uint32_t us;     // micros()
+  uint8_t type;    // TraceType
+  uint8_t phase;   // 'B' begin, 'E' end, 'i' instant (Chrome trace phases)
+  uint16_t arg;
+};
+
+// Dump header (16 bytes), followed by `count` events oldest first
+struct TraceHeader {
+  char magic[4];       // "VMTR"
+  uint16_t version;    // 1
+  uint16_t eventSize;  // sizeof(TraceEvent)
+  uint32_t count;
+  uint32_t lost;       // Overwritten before this dump
+};
+
+TraceEvent traceRing[TRACE_EVENTS];
+uint32_t traceNext = 0;     // Events ever reserved (slot = traceNext % TRACE_EVENTS)
+bool tracePaused = false;   // Set while dumping
+
+// Reserve a slot with one atomic add: safe from the WiFi/WebSocket
+// callbacks without a lock. A slot reused mid-write is at worst one torn event.
+inline void traceRecord(uint8_t type, uint8_t phase, uint16_t arg) {
+  if (tracePaused) return;
+  uint32_t n = __atomic_fetch_add(&traceNext, 1, __ATOMIC_RELAXED);
+  TraceEvent& event = traceRing[n & (TRACE_EVENTS - 1)];
+  event.us = micros();
+  event.type = type;
+  event.phase = phase;
+  event.arg = arg;
+}
+
+// Records the end of a span when it goes out of scope (every return path)
+struct TraceScope {
+  uint8_t type;
+  uint16_t arg;
+  TraceScope(uint8_t t, uint16_t a) : type(t), arg(a) { traceRecord(type, 'B', arg); }
+  ~TraceScope() { traceRecord(type, 'E', arg); }
+};
+
+#define TRACE_INSTANT(type, arg) traceRecord(type, 'i', arg)
+#define TRACE_BEGIN(type, arg)   traceRecord(type, 'B', arg)
+#define TRACE_END(type, arg)     traceRecord(type, 'E', arg)
+#define TRACE_SCOPE(type, arg)   TraceScope traceScope(type, arg)
+
+uint32_t getTraceCount() {
+  return traceNext < TRACE_EVENTS ? traceNext : TRACE_EVENTS;
+}
+
+size_t getTraceDumpSize() {
+  return sizeof(TraceHeader) + getTraceCount() * sizeof(TraceEvent);
+}
+
+// Write the dump to `out` (anything with write(const uint8_t*, size_t)).
+// Recording pauses meanwhile so the ring does not move under the copy.
+template <typename Out>
+void writeTrace(Out& out) {
+  tracePaused = true;
+  uint32_t count = getTraceCount();
+  TraceHeader header = { { 'V', 'M', 'T', 'R' }, 1, sizeof(TraceEvent), count, traceNext - count };
+  out.write((const uint8_t*)&header, sizeof(header));
+
+  // Oldest first: at most two contiguous runs of the ring
+  uint32_t first = (traceNext - count) & (TRACE_EVENTS - 1);
+  uint32_t run = min(count, (uint32_t)TRACE_EVENTS - first);
+  out.write((const uint8_t*)&traceRing[first], run * sizeof(TraceEvent));
+  if (run < count) {
+    out.write((const uint8_t*)&traceRing[0], (count - run) * sizeof(TraceEvent));
+  }
+  tracePaused = false;
+}
+
+#else
+
+#define TRACE_INSTANT(type, arg) do {} while (0)
+#define TRACE_BEGIN(type, arg)   do {} while (0)
+#define TRACE_END(type, arg)     do {} while (0)
+#define TRACE_SCOPE(type, arg)   do {} while (0)
+
+#endif // USE_TRACE
+
+#endif // TRACE_H
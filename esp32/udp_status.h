@@ -0,0 +1,257 @@
+/*
+ * VibeMon UDP Status
+ * Optional fire-and-forget status ingest: one update per datagram, JSON or a
+ * compact binary frame, admitted and queued exactly like POST /status.
+ * Sequence numbers make late and repeated datagrams harmless, an optional
+ * shared secret authenticates them. Enabled with USE_UDP (requires USE_WIFI).
+ */
+
+#ifndef UDP_STATUS_H
+#define UDP_STATUS_H
+
+#if defined(USE_WIFI) && defined(USE_UDP)
+
+#ifdef UDP_SECRET
+#include <mbedtls/md.h>
+#endif
+
+// =============================================================================
+// Datagram Format
+// =============================================================================
+
+// Plain: the datagram is a POST /status body (status, batch array or
+// command). No sequence number and no ack; refused when UDP_SECRET is set.
+//
+// Framed (integers little-endian):
+//   0   "VM"
+//   2   version (1)
+//   3   flags (UDP_FLAG_*)
+//   4   seq u32     per-sender sequence number, 0 = not sequenced
+//   8   sender u32  chosen by the client (e.g. a hash of the project name)
+//   12  body        JSON, or a compact status with UDP_FLAG_COMPACT
+//   ..  tag         UDP_FLAG_TAGGED: first 8 bytes of
+//                   HMAC-SHA256(UDP_SECRET, everything before the tag)
+//
+// Compact status: state u8 (AppState order, 0 = start ... 9 = alert),
+// memory u8 (0-100, 255 = not sent), then project, tool and model as
+// NUL-separated strings (trailing ones may be left out).
+#define UDP_VERSION     1
+#define UDP_HEADER_SIZE 12
+#define UDP_TAG_SIZE    8
+
+#define UDP_FLAG_ACK     0x01  // Reply {"seq":N,"result":"..."} to the sender
+#define UDP_FLAG_COMPACT 0x02  // Body is a compact status
+#define UDP_FLAG_TAGGED  0x04  // HMAC tag appended
+
+WiFiUDP udpStatus;
+uint8_t udpPacket[UDP_PACKET_SIZE + 1];  // +1: NUL after the body
+
+uint32_t readUdpU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// =============================================================================
+// Sequence Tracking
+// =============================================================================
+
+// Last sequence number accepted per (remote IP, sender). A datagram at or
+// below it arrived late or twice and is dropped, so the display never steps
+// back to an older status. Compared with serial-number arithmetic (wraps).
+// A sender silent for UDP_SEQ_RESET_MS may start over (restarted counter).
+// With UDP_SECRET the sender ID is authenticated: it is tracked whatever the
+// address and never starts over, so a captured datagram is refused for as
+// long as its sender stays in the table (since boot, UDP_SENDERS senders).
+struct UdpSender {
+  bool inUse;
+  uint32_t ip;
+  uint32_t sender;
+  uint32_t lastSeq;
+  unsigned long lastSeen;
+};
+
+UdpSender udpSenders[UDP_SENDERS];
+
+// Returns false if seq is not newer than the sender's last accepted one
+bool acceptUdpSeq(uint32_t ip, uint32_t sender, uint32_t seq) {
+  if (seq == 0) return true;
+#ifdef UDP_SECRET
+  ip = 0;
+  const bool mayRestart = false;
+#else
+  const bool mayRestart = true;
+#endif
+  unsigned long now = millis();
+  UdpSender* victim = &udpSenders[0];
+  for (int i = 0; i < UDP_SENDERS; i++) {
+    UdpSender& entry = udpSenders[i];
+    if (entry.inUse && entry.ip == ip && entry.sender == sender) {
+      bool restarted = mayRestart && now - entry.lastSeen >= UDP_SEQ_RESET_MS;
+      if ((int32_t)(seq - entry.lastSeq) <= 0 && !restarted) {
+        return false;
+      }
+      entry.lastSeq = seq;
+      entry.lastSeen = now;
+      return true;
+    }
+    if (!entry.inUse) {
+      victim = &entry;
+    } else if (victim->inUse && entry.lastSeen < victim->lastSeen) {
+      victim = &entry;
+    }
+  }
+  // New sender (least recently seen one recycled)
+  victim->inUse = true;
+  victim->ip = ip;
+  victim->sender = sender;
+  victim->lastSeq = seq;
+  victim->lastSeen = now;
+  return true;
+}
+
+// =============================================================================
+// Authentication
+// =============================================================================
+
+#ifdef UDP_SECRET
+// Check the tag at the end of a framed datagram (len includes the tag)
+bool checkUdpTag(const uint8_t* data, size_t len) {
+  uint8_t mac[32];
+  const mbedtls_md_info_t* sha256 = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  if (mbedtls_md_hmac(sha256, (const uint8_t*)UDP_SECRET, strlen(UDP_SECRET),
+                      data, len - UDP_TAG_SIZE, mac) != 0) {
+    return false;
+  }
+  uint8_t diff = 0;  // Constant time
+  for (int i = 0; i < UDP_TAG_SIZE; i++) diff |= mac[i] ^ data[len - UDP_TAG_SIZE + i];
+  return diff == 0;
+}
+#endif
+
+// =============================================================================
+// Datagram Processing
+// =============================================================================
+
+const char* getUdpResultString(InputResult result) {
+  switch (result) {
+    case INPUT_APPLIED: return "applied";
+    case INPUT_BLOCKED: return "blocked";
+    case INPUT_DUPLICATE: return "duplicate";
+    case INPUT_THROTTLED: return "throttled";
+    case INPUT_COALESCED: return "coalesced";
+    case INPUT_BATCH: return "batch";
+    default: return "invalid";
+  }
+}
+
+void sendUdpAck(uint32_t seq, const char* result) {
+  char ack[48];
+  int len = snprintf(ack, sizeof(ack), "{\"seq\":%lu,\"result\":\"%s\"}", (unsigned long)seq, result);
+  udpStatus.beginPacket(udpStatus.remoteIP(), udpStatus.remotePort());
+  udpStatus.write((const uint8_t*)ack, len);
+  udpStatus.endPacket();
+}
+
+// Compact status body (NUL-terminated by the caller) into the status path
+InputResult processCompactStatus(const uint8_t* body, size_t len, uint32_t sourceId) {
+  TRACE_SCOPE(TRACE_PROCESS_INPUT, INPUT_UDP);
+  beginInput(INPUT_UDP, sourceId);
+  if (len < 2 || body[0] > STATE_ALERT) {
+    Serial.println("{\"error\":\"Invalid compact status\"}");
+    return INPUT_INVALID;
+  }
+
+  // Strings point into the datagram: it outlives the document
+  static const char* const FIELDS[] = { "project", "tool", "model" };
+  StaticJsonDocument<JSON_OBJECT_SIZE(5)> doc;
+  doc["state"] = getStateString((AppState)body[0]);
+  if (body[1] <= 100) doc["memory"] = body[1];
+  const char* field = (const char*)body + 2;
+  const char* end = (const char*)body + len;
+  for (int i = 0; i < 3 && field < end; i++) {
+    doc[FIELDS[i]] = field;
+    field += strlen(field) + 1;
+  }
+  return processStatusInput(doc.as<JsonObject>(), INPUT_UDP);
+}
+
+void handleUdpDatagram(size_t len) {
+  uint32_t ip = (uint32_t)udpStatus.remoteIP();
+  udpPacket[len] = '\0';
+
+  if (len < 2 || udpPacket[0] != 'V' || udpPacket[1] != 'M') {
+#ifdef UDP_SECRET
+    Serial.println("{\"error\":\"Unsigned UDP datagram\"}");
+#else
+    (void)processInput((const char*)udpPacket, INPUT_UDP, ip);
+#endif
+    return;
+  }
+
+  if (len < UDP_HEADER_SIZE || udpPacket[2] != UDP_VERSION) {
+    Serial.println("{\"error\":\"Invalid UDP frame\"}");
+    return;
+  }
+  uint8_t flags = udpPacket[3];
+  uint32_t seq = readUdpU32(udpPacket + 4);
+  uint32_t sender = readUdpU32(udpPacket + 8);
+  size_t end = len;
+  if (flags & UDP_FLAG_TAGGED) {
+    if (len < UDP_HEADER_SIZE + UDP_TAG_SIZE) {
+      Serial.println("{\"error\":\"Invalid UDP frame\"}");
+      return;
+    }
+    end -= UDP_TAG_SIZE;
+  }
+#ifdef UDP_SECRET
+  // Unacknowledged: no replies to senders that don't know the secret. A
+  // sequence number is required so acceptUdpSeq() can refuse replays.
+  if (!(flags & UDP_FLAG_TAGGED) || seq == 0 || !checkUdpTag(udpPacket, len)) {
+    Serial.println("{\"error\":\"UDP authentication failed\"}");
+    return;
+  }
+#endif
+
+  if (!acceptUdpSeq(ip, sender, seq)) {
+    if (flags & UDP_FLAG_ACK) sendUdpAck(seq, "stale");
+    return;
+  }
+
+  udpPacket[end] = '\0';  // Body ends before the tag (already checked)
+  InputResult result;
+  if (flags & UDP_FLAG_COMPACT) {
+    result = processCompactStatus(udpPacket + UDP_HEADER_SIZE, end - UDP_HEADER_SIZE, ip);
+  } else {
+    result = processInput((const char*)udpPacket + UDP_HEADER_SIZE, INPUT_UDP, ip);
+  }
+  if (flags & UDP_FLAG_ACK) sendUdpAck(seq, getUdpResultString(result));
+}
+
+// =============================================================================
+// Listener
+// =============================================================================
+
+void beginUdpStatus() {
+  udpStatus.begin(UDP_STATUS_PORT);
+  Serial.print("{\"udp\":\"listening\",\"port\":");
+  Serial.print(UDP_STATUS_PORT);
+  Serial.println("}");
+}
+
+// Called from loop(): handle the datagrams that have arrived, a few per pass
+void pollUdpStatus() {
+  for (int i = 0; i < UDP_PACKETS_PER_LOOP; i++) {
+    int size = udpStatus.parsePacket();
+    if (size <= 0) return;
+    TRACE_INSTANT(TRACE_INPUT, INPUT_UDP);
+    if (size > UDP_PACKET_SIZE) {
+      Serial.println("{\"error\":\"UDP datagram too large\"}");
+      continue;  // Rest discarded by the next parsePacket()
+    }
+    int len = udpStatus.read(udpPacket, UDP_PACKET_SIZE);
+    if (len > 0) handleUdpDatagram((size_t)len);
+  }
+}
+
+#endif // USE_WIFI && USE_UDP
+
+#endif // UDP_STATUS_H
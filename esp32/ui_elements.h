@@ -3,7 +3,7 @@
  * Status text functions and UI icon drawing
  *
  * Dependencies (must be included before this file):
- *   - TFT_Compat.h (TFT_eSPI type)
+ *   - TFT_Compat.h (TFT_eSPI / TFT_eSprite types)
  *   - sprites.h (AppState enum)
  */
 
@@ -81,58 +81,62 @@ void getStatusTextEnum(AppState state, char* buf, size_t bufSize) {
 }
 
 // =============================================================================
-// UI Icon Functions
+// UI Icon Functions (template: draw to TFT or to a sprite)
 // =============================================================================
 
 // Draw folder icon - s=1: 10x10, s=2: 20x20 pixels
-void drawFolderIcon(TFT_eSPI &tft, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
+template<typename T>
+void drawFolderIcon(T &canvas, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
   // Folder tab (top-left)
-  tft.fillRect(x, y, 4*s, 2*s, color);
+  canvas.fillRect(x, y, 4*s, 2*s, color);
   // Folder body
-  tft.fillRect(x, y + 2*s, 10*s, 8*s, color);
+  canvas.fillRect(x, y + 2*s, 10*s, 8*s, color);
   // Inner fold line (cut through with background color)
-  tft.fillRect(x + s, y + 4*s, 8*s, s, bg);
+  canvas.fillRect(x + s, y + 4*s, 8*s, s, bg);
 }
 
 // Draw tool/wrench icon - s=1: 10x10, s=2: 20x20 pixels
-void drawToolIcon(TFT_eSPI &tft, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
+template<typename T>
+void drawToolIcon(T &canvas, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
   // Wrench head (top)
-  tft.fillRect(x + 2*s, y, 6*s, 4*s, color);
-  tft.fillRect(x + 4*s, y, 2*s, s, bg);  // Notch
+  canvas.fillRect(x + 2*s, y, 6*s, 4*s, color);
+  canvas.fillRect(x + 4*s, y, 2*s, s, bg);  // Notch
   // Handle
-  tft.fillRect(x + 4*s, y + 4*s, 2*s, 6*s, color);
+  canvas.fillRect(x + 4*s, y + 4*s, 2*s, 6*s, color);
 }
 
 // Draw robot icon - s=1: 10x10, s=2: 20x20 pixels
-void drawRobotIcon(TFT_eSPI &tft, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
+template<typename T>
+void drawRobotIcon(T &canvas, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
   // Antenna
-  tft.fillRect(x + 4*s, y, 2*s, 2*s, color);
+  canvas.fillRect(x + 4*s, y, 2*s, 2*s, color);
   // Head
-  tft.fillRect(x + s, y + 2*s, 8*s, 6*s, color);
+  canvas.fillRect(x + s, y + 2*s, 8*s, 6*s, color);
   // Eyes (cut through with background color)
-  tft.fillRect(x + 3*s, y + 4*s, s, 2*s, bg);
-  tft.fillRect(x + 6*s, y + 4*s, s, 2*s, bg);
+  canvas.fillRect(x + 3*s, y + 4*s, s, 2*s, bg);
+  canvas.fillRect(x + 6*s, y + 4*s, s, 2*s, bg);
   // Mouth
-  tft.fillRect(x + 3*s, y + 7*s, 4*s, s, bg);
+  canvas.fillRect(x + 3*s, y + 7*s, 4*s, s, bg);
   // Ears
-  tft.fillRect(x, y + 3*s, s, 3*s, color);
-  tft.fillRect(x + 9*s, y + 3*s, s, 3*s, color);
+  canvas.fillRect(x, y + 3*s, s, 3*s, color);
+  canvas.fillRect(x + 9*s, y + 3*s, s, 3*s, color);
 }
 
 // Draw brain icon - s=1: 10x10, s=2: 20x20 pixels
-void drawBrainIcon(TFT_eSPI &tft, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
+template<typename T>
+void drawBrainIcon(T &canvas, int x, int y, uint16_t color, int s = 1, uint16_t bg = 0x0000) {
   // Brain shape
-  tft.fillRect(x + s, y, 8*s, 10*s, color);
-  tft.fillRect(x, y + 2*s, 10*s, 6*s, color);
+  canvas.fillRect(x + s, y, 8*s, 10*s, color);
+  canvas.fillRect(x, y + 2*s, 10*s, 6*s, color);
   // Brain folds (cut through with background color)
-  tft.fillRect(x + 5*s, y + s, s, 8*s, bg);
+  canvas.fillRect(x + 5*s, y + s, s, 8*s, bg);
   // Left fold
-  tft.fillRect(x + 3*s, y + 3*s, s, 3*s, bg);
+  canvas.fillRect(x + 3*s, y + 3*s, s, 3*s, bg);
   // Right fold
-  tft.fillRect(x + 7*s, y + 4*s, s, 3*s, bg);
+  canvas.fillRect(x + 7*s, y + 4*s, s, 3*s, bg);
   // Top bumps
-  tft.fillRect(x + 3*s, y, s, s, bg);
-  tft.fillRect(x + 7*s, y, s, s, bg);
+  canvas.fillRect(x + 3*s, y, s, s, bg);
+  canvas.fillRect(x + 7*s, y, s, s, bg);
 }
 
 #endif // UI_ELEMENTS_H
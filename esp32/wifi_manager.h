@@ -1,6 +1,6 @@
 /*
  * VibeMon WiFi
- * WiFi connection, HTTP server, WebSocket client, and provisioning
+ * WiFi connection, status API handlers, WebSocket client, and provisioning
  */
 
 #ifndef WIFI_MANAGER_H
@@ -8,16 +8,82 @@
 
 #ifdef USE_WIFI
 
+// =============================================================================
+// Connection Cache (fast reconnect)
+// =============================================================================
+
+// The access point and IP configuration of the last successful connection
+// live in settings. Trying them first skips the channel scan (and, with
+// WIFI_REUSE_IP, the DHCP exchange) on boot.
+
+bool hasWiFiCache() {
+  return settings.wifiChannel != 0;
+}
+
+void clearWiFiCache() {
+  if (!hasWiFiCache()) return;
+  memset(settings.wifiBssid, 0, sizeof(settings.wifiBssid));
+  settings.wifiChannel = 0;
+  settings.wifiIP = settings.wifiGateway = settings.wifiSubnet = settings.wifiDns = 0;
+  markSettingsDirty();
+}
+
+// Remember the connection just made (written only if it changed: roaming
+// to another access point or a new DHCP lease)
+void saveWiFiCache() {
+  const uint8_t* bssid = WiFi.BSSID();
+  uint8_t channel = (uint8_t)WiFi.channel();
+  if (!bssid || channel == 0) return;
+  uint32_t ip = WiFi.localIP();
+  uint32_t gateway = WiFi.gatewayIP();
+  uint32_t subnet = WiFi.subnetMask();
+  uint32_t dns = WiFi.dnsIP();
+  if (memcmp(settings.wifiBssid, bssid, sizeof(settings.wifiBssid)) == 0 && settings.wifiChannel == channel &&
+      settings.wifiIP == ip && settings.wifiGateway == gateway && settings.wifiSubnet == subnet &&
+      settings.wifiDns == dns) {
+    return;
+  }
+  memcpy(settings.wifiBssid, bssid, sizeof(settings.wifiBssid));
+  settings.wifiChannel = channel;
+  settings.wifiIP = ip;
+  settings.wifiGateway = gateway;
+  settings.wifiSubnet = subnet;
+  settings.wifiDns = dns;
+  markSettingsDirty();
+}
+
+// Start connecting straight to the cached access point (false: no cache)
+bool beginFastConnect() {
+  if (!hasWiFiCache()) return false;
+#if WIFI_REUSE_IP
+  if (settings.wifiIP != 0) {
+    WiFi.config(IPAddress(settings.wifiIP), IPAddress(settings.wifiGateway),
+                IPAddress(settings.wifiSubnet), IPAddress(settings.wifiDns));
+  }
+#endif
+  WiFi.begin(wifiSSID, wifiPassword, settings.wifiChannel, settings.wifiBssid);
+  return true;
+}
+
+// Cached access point did not answer (gone, moved to another channel,
+// password changed): drop the cache, back to scan and DHCP
+void abandonFastConnect() {
+  Serial.println("{\"wifi\":\"fast_connect_failed\"}");
+  WiFi.disconnect();
+#if WIFI_REUSE_IP
+  WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);  // Back to DHCP
+#endif
+  clearWiFiCache();
+}
+
 // =============================================================================
 // WiFi Credentials
 // =============================================================================
 
-// Load WiFi credentials from Preferences
+// Load WiFi credentials from settings
 void loadWiFiCredentials() {
-  preferences.begin("vibemon", true);  // Read-only
-  preferences.getString("wifiSSID", wifiSSID, sizeof(wifiSSID));
-  preferences.getString("wifiPassword", wifiPassword, sizeof(wifiPassword));
-  preferences.end();
+  safeCopyStr(wifiSSID, settings.wifiSSID);
+  safeCopyStr(wifiPassword, settings.wifiPassword);
 
   // If no saved credentials, try using default from credentials.h
   if (strlen(wifiSSID) == 0 && strlen(defaultSSID) > 0) {
@@ -26,23 +92,21 @@ void loadWiFiCredentials() {
   }
 }
 
-// Save WiFi credentials to Preferences
+// Save WiFi credentials to settings (written from loop() or before restart)
 void saveWiFiCredentials(const char* ssid, const char* password) {
-  preferences.begin("vibemon", false);  // Read-write
-  preferences.putString("wifiSSID", ssid);
-  preferences.putString("wifiPassword", password);
-  preferences.end();
+  safeCopyStr(settings.wifiSSID, ssid);
+  safeCopyStr(settings.wifiPassword, password);
+  clearWiFiCache();  // Cached access point belongs to the old network
+  markSettingsDirty();
 
   safeCopyStr(wifiSSID, ssid);
   safeCopyStr(wifiPassword, password);
 }
 
 #ifdef USE_WEBSOCKET
-// Load WebSocket token from Preferences
+// Load WebSocket token from settings
 void loadWebSocketToken() {
-  preferences.begin("vibemon", true);  // Read-only
-  preferences.getString("wsToken", wsToken, sizeof(wsToken));
-  preferences.end();
+  safeCopyStr(wsToken, settings.wsToken);
 
   // If no saved token, try using default from credentials.h
   if (strlen(wsToken) == 0 && strlen(defaultWSToken) > 0) {
@@ -50,20 +114,139 @@ void loadWebSocketToken() {
   }
 }
 
-// Save WebSocket token to Preferences
+// Save WebSocket token to settings (written from loop() or before restart)
 void saveWebSocketToken(const char* token) {
   if (strlen(token) >= sizeof(wsToken)) {
     Serial.println("{\"error\":\"Token too long (max 127 chars)\"}");
     return;
   }
-  preferences.begin("vibemon", false);  // Read-write
-  preferences.putString("wsToken", token);
-  preferences.end();
+  safeCopyStr(settings.wsToken, token);
+  markSettingsDirty();
 
   safeCopyStr(wsToken, token);
 }
 #endif
 
+// =============================================================================
+// Network Scan (provisioning portal)
+// =============================================================================
+
+// Scans run in the background (WiFi.scanNetworks(true), polled from loop())
+// so the portal keeps answering. GET /scan returns the cached list at once
+// and starts a new scan when it is older than WIFI_SCAN_MAX_AGE_MS.
+struct WiFiNetwork {
+  char ssid[33];
+  int8_t rssi;
+  bool secure;
+};
+
+WiFiNetwork wifiNetworks[WIFI_SCAN_MAX];  // Strongest first, one entry per SSID
+int wifiNetworkCount = 0;
+unsigned long wifiScanAt = 0;             // When the cached list was taken (millis)
+bool wifiScanned = false;                 // wifiNetworks holds a scan
+bool wifiScanRunning = false;
+
+void startWiFiScan() {
+  if (wifiScanRunning) return;
+  if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+    Serial.println("{\"error\":\"WiFi scan failed to start\"}");
+    return;
+  }
+  wifiScanRunning = true;
+}
+
+// Add a scan result, keeping the list sorted by signal and the strongest
+// access point per SSID (several APs often share one)
+void addWiFiNetwork(const char* ssid, int rssi, bool secure) {
+  if (ssid[0] == '\0') return;  // Hidden network
+  int pos = wifiNetworkCount;
+  for (int i = 0; i < wifiNetworkCount; i++) {
+    if (strcmp(wifiNetworks[i].ssid, ssid) == 0) {
+      if (wifiNetworks[i].rssi >= rssi) return;
+      pos = i;  // Stronger AP: take this entry out, re-insert below
+      break;
+    }
+  }
+  if (pos == wifiNetworkCount) {
+    if (wifiNetworkCount == WIFI_SCAN_MAX) {
+      if (wifiNetworks[WIFI_SCAN_MAX - 1].rssi >= rssi) return;
+      pos = WIFI_SCAN_MAX - 1;  // Weakest makes room
+    } else {
+      wifiNetworkCount++;
+    }
+  }
+  while (pos > 0 && wifiNetworks[pos - 1].rssi < rssi) {
+    wifiNetworks[pos] = wifiNetworks[pos - 1];
+    pos--;
+  }
+  WiFiNetwork& network = wifiNetworks[pos];
+  safeCopyStr(network.ssid, ssid);
+  network.rssi = (int8_t)constrain(rssi, -128, 127);
+  network.secure = secure;
+}
+
+// Called from loop() in provisioning mode: collect finished scan results
+void pollWiFiScan() {
+  if (!wifiScanRunning) return;
+  int16_t n = WiFi.scanComplete();
+  if (n == WIFI_SCAN_RUNNING) return;
+  wifiScanRunning = false;
+  if (n < 0) {
+    Serial.println("{\"error\":\"WiFi scan failed\"}");
+    return;  // Previous list stays
+  }
+
+  wifiNetworkCount = 0;
+  for (int i = 0; i < n; i++) {
+    addWiFiNetwork(WiFi.SSID(i).c_str(), WiFi.RSSI(i), WiFi.encryptionType(i) != WIFI_AUTH_OPEN);
+  }
+  WiFi.scanDelete();  // Results copied: free the driver's list
+  wifiScanAt = millis();
+  wifiScanned = true;
+
+  char msg[48];
+  snprintf(msg, sizeof(msg), "{\"wifi\":\"scan_done\",\"networks\":%d}", wifiNetworkCount);
+  Serial.println(msg);
+}
+
+void sendWiFiScanChunk(const char* data, size_t len) {
+  server.sendContent(data, len);
+}
+
+// GET /scan: {"networks":[...],"scanning":bool,"ageMs":N}. While the first
+// scan runs the list is empty and "scanning" is true (the portal asks again).
+void handleWiFiScan() {
+  if (!wifiScanned || millis() - wifiScanAt >= WIFI_SCAN_MAX_AGE_MS) startWiFiScan();
+
+  char buf[128];
+  JsonWriter json;
+  jsonBegin(json, buf, sizeof(buf), sendWiFiScanChunk);
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+
+  jsonBeginObject(json);
+  jsonKey(json, "networks");
+  jsonBeginArray(json);
+  for (int i = 0; i < wifiNetworkCount; i++) {
+    jsonBeginObject(json);
+    jsonKey(json, "ssid");
+    jsonString(json, wifiNetworks[i].ssid);
+    jsonKey(json, "rssi");
+    jsonInt(json, wifiNetworks[i].rssi);
+    jsonKey(json, "secure");
+    jsonBool(json, wifiNetworks[i].secure);
+    jsonEndObject(json);
+  }
+  jsonEndArray(json);
+  jsonKey(json, "scanning");
+  jsonBool(json, wifiScanRunning);
+  jsonKey(json, "ageMs");
+  jsonInt(json, wifiScanned ? (long)(millis() - wifiScanAt) : -1);
+  jsonEndObject(json);
+  jsonFlush(json);
+  server.sendContent("");  // End of chunked response
+}
+
 // =============================================================================
 // Provisioning Mode
 // =============================================================================
@@ -102,6 +285,9 @@ void startProvisioningMode() {
   // Setup web server for configuration
   setupProvisioningServer();
 
+  // First scan now: the list is ready when the portal page asks for it
+  startWiFiScan();
+
   char provMsg[80];
   snprintf(provMsg, sizeof(provMsg), "{\"wifi\":\"provisioning_mode\",\"ssid\":\"%s\"}", AP_SSID);
   Serial.println(provMsg);
@@ -114,31 +300,8 @@ void setupProvisioningServer() {
     server.send(200, "text/html", CONFIG_PAGE);
   });
 
-  // WiFi scan endpoint
-  server.on("/scan", HTTP_GET, []() {
-    int n = WiFi.scanNetworks();
-    String json;
-    json.reserve(20 + n * 80);  // Pre-allocate: ~80 chars per network entry
-    json = "{\"networks\":[";
-    for (int i = 0; i < n; i++) {
-      if (i > 0) json += ",";
-      // Escape SSID for JSON safety
-      String ssid = WiFi.SSID(i);
-      // Remove control characters (0x00-0x1F) that break JSON
-      for (int j = ssid.length() - 1; j >= 0; j--) {
-        if (ssid[j] < 0x20) ssid.remove(j, 1);
-      }
-      ssid.replace("\\", "\\\\");  // Escape backslashes first
-      ssid.replace("\"", "\\\"");  // Escape quotes
-      char entry[96];
-      snprintf(entry, sizeof(entry), "{\"ssid\":\"%s\",\"rssi\":%d,\"secure\":%s}",
-        ssid.c_str(), WiFi.RSSI(i),
-        WiFi.encryptionType(i) != WIFI_AUTH_OPEN ? "true" : "false");
-      json += entry;
-    }
-    json += "]}";
-    server.send(200, "application/json", json);
-  });
+  // WiFi scan endpoint: cached list right away, refreshed in the background
+  server.on("/scan", HTTP_GET, handleWiFiScan);
 
   // Save credentials endpoint
   server.on("/save", HTTP_POST, []() {
@@ -172,6 +335,7 @@ void setupProvisioningServer() {
 
       server.send(200, "application/json", "{\"success\":true,\"message\":\"Credentials saved. Rebooting...\"}");
 
+      persistBeforeRestart();
       delay(1000);
       ESP.restart();
     } else {
@@ -187,43 +351,153 @@ void setupProvisioningServer() {
 // =============================================================================
 
 void handleStatus() {
-  if (server.hasArg("plain")) {
-    // Use const reference to avoid String copy (heap allocation)
-    const String& body = server.arg("plain");
-    bool applied = processInput(body.c_str());
-    if (applied) {
-      server.send(200, "application/json", "{\"success\":true}");
+  TRACE_INSTANT(TRACE_INPUT, INPUT_HTTP);
+  if (httpHasBody()) {
+    InputResult result = processInput(httpBody(), INPUT_HTTP, httpRemoteIP());
+    if (result == INPUT_APPLIED) {
+      httpSend(200, "application/json", "{\"success\":true}");
+    } else if (result == INPUT_DUPLICATE) {
+      httpSend(200, "application/json", "{\"success\":true,\"duplicate\":true}");
+    } else if (result == INPUT_COALESCED) {
+      httpSend(200, "application/json", "{\"success\":true,\"coalesced\":true}");
+    } else if (result == INPUT_BATCH) {
+      char response[64 + MAX_BATCH_ITEMS * 40];
+      buildBatchResponseJson(response, sizeof(response));
+      httpSend(200, "application/json", response);
+    } else if (result == INPUT_THROTTLED) {
+      httpSend(429, "application/json", "{\"success\":false,\"throttled\":true}");
+    } else if (result == INPUT_INVALID) {
+      httpSend(400, "application/json", "{\"error\":\"invalid payload\"}");
     } else {
-      server.send(200, "application/json", "{\"success\":false,\"blocked\":true}");
+      httpSend(200, "application/json", "{\"success\":false,\"blocked\":true}");
     }
   } else {
-    server.send(400, "application/json", "{\"error\":\"no body\"}");
+    httpSend(400, "application/json", "{\"error\":\"no body\"}");
   }
 }
 
+// GET /status. With since/wait: the snapshot with its sequence number, as a
+// long poll when the client already has the current one
 void handleStatusGet() {
-  char response[256];
-  buildStatusJson(response, sizeof(response));
-  server.send(200, "application/json", response);
+  long since = httpQueryParam("since", -1);
+  long wait = httpQueryParam("wait", -1);
+  if (since < 0 && wait < 0) {
+    char response[STATUS_JSON_SIZE];
+    buildStatusJson(response, sizeof(response));
+    httpSend(200, "application/json", response);
+    return;
+  }
+
+  refreshStatusEvent();
+  if (since < 0) since = statusSeq;  // Wait for the next change
+  if ((uint32_t)since != statusSeq || wait <= 0) {
+    httpSendStatusEvent();
+  } else {
+    httpWaitForStatus((uint32_t)since, min(wait, (long)HTTP_LONG_POLL_MAX_MS));
+  }
+}
+
+// GET /events: Server-Sent Events stream of status changes
+void handleEvents() {
+  httpBeginEventStream(httpLastEventId());
 }
 
+void handleMetrics() {
+  char response[METRICS_JSON_SIZE];
+  buildMetricsJson(response, sizeof(response));
+  httpSend(200, "application/json", response);
+}
+
+// Chunked response writer for writeStatsJson(): pieces are collected in a
+// small buffer and sent as HTTP chunks, so the body is never held in full
+struct HttpChunkWriter {
+  char buf[HTTP_CHUNK_SIZE];
+  size_t len = 0;
+
+  void print(const char* s) {
+    size_t n = strlen(s);
+    if (len + n > sizeof(buf)) flush();
+    if (n > sizeof(buf)) {
+      httpSendChunk(s, n);
+      return;
+    }
+    memcpy(buf + len, s, n);
+    len += n;
+  }
+
+  void flush() {
+    httpSendChunk(buf, len);
+    len = 0;
+  }
+};
+
+void handleStats() {
+  httpBeginChunked(200, "application/json");
+  HttpChunkWriter out;
+  writeStatsJson(out);
+  out.flush();
+  httpEndChunked();
+}
+
+void handleLatency() {
+  httpBeginChunked(200, "application/json");
+  HttpChunkWriter out;
+  writeLatencyJson(out);
+  out.flush();
+  httpEndChunked();
+}
+
+void handleLatencyReset() {
+  resetLatencyStats();
+  httpSend(200, "application/json", "{\"success\":true}");
+}
+
+#ifdef USE_TRACE
+// Binary trace dump (see tools/trace_to_chrome.py)
+struct HttpBinaryWriter {
+  void write(const uint8_t* data, size_t len) {
+    httpWrite(data, len);
+  }
+};
+
+void handleTrace() {
+  httpBeginResponse(200, "application/octet-stream", getTraceDumpSize());
+  HttpBinaryWriter out;
+  writeTrace(out);
+}
+#endif
+
 void handleHealth() {
-  server.send(200, "application/json", "{\"status\":\"ok\"}");
+  httpSend(200, "application/json", "{\"status\":\"ok\"}");
+}
+
+// {"success":true,"lockedProject":"..."} (the name is escaped)
+void sendLockedProject() {
+  char response[STATUS_JSON_SIZE];
+  JsonWriter json;
+  jsonBegin(json, response, sizeof(response) - 1);  // Room for the NUL
+  jsonBeginObject(json);
+  jsonKey(json, "success");
+  jsonBool(json, true);
+  jsonKey(json, "lockedProject");
+  jsonString(json, getLockedProject());
+  jsonEndObject(json);
+  response[json.len] = '\0';
+  httpSend(200, "application/json", response);
 }
 
 void handleLock() {
-  char response[128];
-  if (server.hasArg("plain")) {
+  unsigned long startUs = micros();
+  drainStatusQueue();  // Control lane: observe status updates received before this lock
+  if (httpHasBody()) {
     StaticJsonDocument<128> doc;
-    // Use const reference to avoid String copy
-    const String& body = server.arg("plain");
-    DeserializationError error = deserializeJson(doc, body);
+    DeserializationError error = deserializeJson(doc, httpBody());
     if (!error) {
       const char* projectToLock = doc["project"] | currentProject;
       if (strlen(projectToLock) > 0) {
         lockProject(projectToLock);
-        snprintf(response, sizeof(response), "{\"success\":true,\"lockedProject\":\"%s\"}", lockedProject);
-        server.send(200, "application/json", response);
+        sendLockedProject();
+        recordLaneLatency(LANE_CONTROL, startUs);
         return;
       }
     }
@@ -231,70 +505,154 @@ void handleLock() {
   // No body or no project - lock current project
   if (strlen(currentProject) > 0) {
     lockProject(currentProject);
-    snprintf(response, sizeof(response), "{\"success\":true,\"lockedProject\":\"%s\"}", lockedProject);
-    server.send(200, "application/json", response);
+    sendLockedProject();
+    recordLaneLatency(LANE_CONTROL, startUs);
   } else {
-    server.send(400, "application/json", "{\"error\":\"No project to lock\"}");
+    httpSend(400, "application/json", "{\"error\":\"No project to lock\"}");
   }
 }
 
 void handleUnlock() {
+  unsigned long startUs = micros();
+  drainStatusQueue();
   unlockProject();
-  server.send(200, "application/json", "{\"success\":true,\"lockedProject\":null}");
+  httpSend(200, "application/json", "{\"success\":true,\"lockedProject\":null}");
+  recordLaneLatency(LANE_CONTROL, startUs);
 }
 
 void handleLockModeGet() {
-  char response[256];
-  if (strlen(lockedProject) > 0) {
-    snprintf(response, sizeof(response),
-      "{\"mode\":\"%s\",\"modes\":{\"first-project\":\"First Project\",\"on-thinking\":\"On Thinking\"},\"lockedProject\":\"%s\"}",
-      getLockModeString(), lockedProject);
+  char response[STATUS_JSON_SIZE];
+  JsonWriter json;
+  jsonBegin(json, response, sizeof(response) - 1);  // Room for the NUL
+  jsonBeginObject(json);
+  jsonKey(json, "mode");
+  jsonString(json, getLockModeString());
+  jsonKey(json, "modes");
+  jsonBeginObject(json);
+  jsonKey(json, "first-project");
+  jsonString(json, "First Project");
+  jsonKey(json, "on-thinking");
+  jsonString(json, "On Thinking");
+  jsonEndObject(json);
+  jsonKey(json, "lockedProject");
+  if (lockedProjectId != PROJECT_NONE) {
+    jsonString(json, getLockedProject());
   } else {
-    snprintf(response, sizeof(response),
-      "{\"mode\":\"%s\",\"modes\":{\"first-project\":\"First Project\",\"on-thinking\":\"On Thinking\"},\"lockedProject\":null}",
-      getLockModeString());
+    jsonNull(json);
   }
-  server.send(200, "application/json", response);
+  jsonEndObject(json);
+  response[json.len] = '\0';
+  httpSend(200, "application/json", response);
 }
 
 void handleLockModePost() {
-  if (server.hasArg("plain")) {
+  if (httpHasBody()) {
     StaticJsonDocument<128> doc;
-    // Use const reference to avoid String copy
-    const String& body = server.arg("plain");
-    DeserializationError error = deserializeJson(doc, body);
+    DeserializationError error = deserializeJson(doc, httpBody());
     if (!error) {
       const char* modeStr = doc["mode"] | "";
       if (strlen(modeStr) > 0) {
         int newMode = parseLockMode(modeStr);
         if (newMode >= 0) {
+          drainStatusQueue();
           setLockMode(newMode);
           char response[64];
           snprintf(response, sizeof(response), "{\"success\":true,\"mode\":\"%s\",\"lockedProject\":null}", getLockModeString());
-          server.send(200, "application/json", response);
+          httpSend(200, "application/json", response);
           return;
         }
       }
     }
   }
-  server.send(400, "application/json", "{\"error\":\"Invalid mode. Valid modes: first-project, on-thinking\"}");
+  httpSend(400, "application/json", "{\"error\":\"Invalid mode. Valid modes: first-project, on-thinking\"}");
+}
+
+void handleViewGet() {
+  char response[160];
+  snprintf(response, sizeof(response),
+    "{\"view\":\"%s\",\"views\":{\"single\":\"Single Project\",\"dashboard\":\"Dashboard\",\"rotation\":\"Rotation\"}}",
+    getViewModeString());
+  httpSend(200, "application/json", response);
+}
+
+void handleViewPost() {
+  if (httpHasBody()) {
+    StaticJsonDocument<128> doc;
+    DeserializationError error = deserializeJson(doc, httpBody());
+    if (!error) {
+      const char* modeStr = doc["mode"] | "";
+      int newMode = parseViewMode(modeStr);
+      if (newMode >= 0) {
+        setViewMode(newMode);
+        char response[64];
+        snprintf(response, sizeof(response), "{\"success\":true,\"view\":\"%s\"}", getViewModeString());
+        httpSend(200, "application/json", response);
+        return;
+      }
+    }
+  }
+  httpSend(400, "application/json", "{\"error\":\"Invalid mode. Valid modes: single, dashboard, rotation\"}");
 }
 
 void handleReboot() {
   // Require {"confirm":true} in request body to prevent accidental/unauthorized reboots
-  if (server.hasArg("plain")) {
+  if (httpHasBody()) {
     StaticJsonDocument<64> doc;
-    deserializeJson(doc, server.arg("plain"));
+    deserializeJson(doc, httpBody());
     if (doc["confirm"] == true) {
-      server.send(200, "application/json", "{\"success\":true,\"rebooting\":true}");
+      httpSend(200, "application/json", "{\"success\":true,\"rebooting\":true}");
+      persistBeforeRestart();
       delay(100);  // Allow HTTP response to complete
       ESP.restart();
       return;
     }
   }
-  server.send(400, "application/json", "{\"error\":\"Requires {\\\"confirm\\\":true}\"}");
+  httpSend(400, "application/json", "{\"error\":\"Requires {\\\"confirm\\\":true}\"}");
+}
+
+// WiFi reset - requires {"confirm":true} to prevent accidental resets
+void handleWiFiReset() {
+  if (httpHasBody()) {
+    StaticJsonDocument<64> doc;
+    deserializeJson(doc, httpBody());
+    if (doc["confirm"] == true) {
+      settings.wifiSSID[0] = '\0';
+      settings.wifiPassword[0] = '\0';
+      clearWiFiCache();
+      markSettingsDirty();
+      httpSend(200, "application/json", "{\"success\":true,\"message\":\"WiFi credentials cleared. Rebooting...\"}");
+      persistBeforeRestart();
+      delay(1000);
+      ESP.restart();
+      return;
+    }
+  }
+  httpSend(400, "application/json", "{\"error\":\"Requires {\\\"confirm\\\":true}\"}");
 }
 
+// Status API (station mode)
+const HttpRoute statusApiRoutes[] = {
+  { "/status", HTTP_POST, handleStatus },
+  { "/status", HTTP_GET, handleStatusGet },
+  { "/events", HTTP_GET, handleEvents },
+  { "/health", HTTP_GET, handleHealth },
+  { "/metrics", HTTP_GET, handleMetrics },
+  { "/stats", HTTP_GET, handleStats },
+  { "/latency", HTTP_GET, handleLatency },
+  { "/latency", HTTP_DELETE, handleLatencyReset },
+#ifdef USE_TRACE
+  { "/trace", HTTP_GET, handleTrace },
+#endif
+  { "/lock", HTTP_POST, handleLock },
+  { "/unlock", HTTP_POST, handleUnlock },
+  { "/lock-mode", HTTP_GET, handleLockModeGet },
+  { "/lock-mode", HTTP_POST, handleLockModePost },
+  { "/view", HTTP_GET, handleViewGet },
+  { "/view", HTTP_POST, handleViewPost },
+  { "/reboot", HTTP_POST, handleReboot },
+  { "/wifi-reset", HTTP_POST, handleWiFiReset },
+};
+
 // =============================================================================
 // WiFi Setup & Connection
 // =============================================================================
@@ -304,7 +662,100 @@ void handleReboot() {
 void setupWebSocket();
 #endif
 
-void setupWiFi() {
+// Bring-up runs as a state machine driven from loop(), so the display,
+// Serial input and animation work from the first frame while WiFi connects
+enum WiFiConnState : uint8_t {
+  WIFI_CONN_IDLE,        // Not started, or provisioning mode
+  WIFI_CONN_FAST,        // Trying the cached access point
+  WIFI_CONN_JOINING,     // Full path: WiFi.begin(), waiting (round wifiRound)
+  WIFI_CONN_ROUND_WAIT,  // Disconnected between rounds
+  WIFI_CONN_FAILED,      // Every round failed: provisioning mode shortly
+  WIFI_CONN_CONNECTED    // Services started; checkWiFiConnection() watches the link
+};
+
+WiFiConnState wifiConnState = WIFI_CONN_IDLE;
+unsigned long wifiConnStateAt = 0;  // When wifiConnState was entered (millis)
+int wifiRound = 0;
+bool wifiShowProgress = false;      // Progress lines on the start screen
+
+void setWiFiConnState(WiFiConnState state) {
+  wifiConnState = state;
+  wifiConnStateAt = millis();
+}
+
+// Connected and network services started (status API, UDP, LAN WebSocket)
+bool isWiFiReady() {
+  return wifiConnState == WIFI_CONN_CONNECTED;
+}
+
+// Progress at Y=230, only while the start screen is up (never over a status)
+void drawWiFiProgress(const char* line1, const char* line2 = nullptr) {
+  if (!wifiShowProgress || currentState != STATE_START || projectCount > 0) return;
+  int wifiY = 230;
+  tft.fillRect(0, wifiY, SCREEN_WIDTH, 28, TFT_BLACK);
+  tft.setTextColor(COLOR_TEXT_DIM);
+  tft.setTextSize(1);
+  tft.setCursor(10, wifiY);
+  tft.print(line1);
+  if (line2) {
+    tft.setCursor(10, wifiY + 18);
+    tft.print(line2);
+  }
+}
+
+void beginWiFiRound() {
+  char progress[32];
+  if (wifiRound > 0) {
+    snprintf(progress, sizeof(progress), "WiFi: connecting R%d", wifiRound + 1);
+  } else {
+    safeCopyStr(progress, "WiFi: connecting");
+  }
+  drawWiFiProgress(progress);
+  WiFi.begin(wifiSSID, wifiPassword);
+  setWiFiConnState(WIFI_CONN_JOINING);
+}
+
+void onWiFiConnected(bool fast) {
+  setWiFiConnState(WIFI_CONN_CONNECTED);
+  wifiWasConnected = true;
+  wifiConnectMs = millis();
+  wifiFastConnect = fast;
+  saveWiFiCache();
+  drawConnectionIndicator();
+
+  char ip[16];
+  safeCopyStr(ip, WiFi.localIP().toString().c_str());
+  char line[24];
+  snprintf(line, sizeof(line), "IP: %s", ip);
+  drawWiFiProgress("WiFi: OK", line);
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "{\"wifi\":\"connected\",\"ip\":\"%s\",\"connectMs\":%lu,\"fastConnect\":%s}",
+    ip, wifiConnectMs, fast ? "true" : "false");
+  Serial.println(msg);
+
+  // Enable WiFi modem sleep (WIFI_PS_MIN_MODEM) to reduce radio power and heat.
+  // Heartbeat timeout relaxed to 10s (from 3s) to accommodate modem sleep latency.
+  WiFi.setSleep(true);
+
+  // Status API server (the provisioning portal uses WebServer instead)
+  beginHttpServer(statusApiRoutes, sizeof(statusApiRoutes) / sizeof(statusApiRoutes[0]));
+#ifdef USE_UDP
+  beginUdpStatus();
+#endif
+#ifdef USE_WS_SERVER
+  beginWsServer();
+#endif
+#ifdef USE_WEBSOCKET
+  setupWebSocket();
+#endif
+}
+
+// Called from setup(): start connecting and return at once. showProgress:
+// the start screen is up and may show the connection progress.
+void setupWiFi(bool showProgress) {
+  wifiShowProgress = showProgress;
+
   // Load saved WiFi credentials
   loadWiFiCredentials();
 
@@ -315,88 +766,68 @@ void setupWiFi() {
     return;
   }
 
-  // Try to connect to WiFi with retry rounds
   WiFi.mode(WIFI_STA);
   WiFi.setAutoReconnect(true);
 
-  // Display WiFi status at Y=230 for better visibility
-  int wifiY = 230;
-  tft.setCursor(10, wifiY);
-  tft.setTextColor(COLOR_TEXT_DIM);
-  tft.setTextSize(1);
-  tft.print("WiFi: ");
-
-  for (int retry = 0; retry < WIFI_CONNECT_RETRIES; retry++) {
-    if (retry > 0) {
-      tft.print("R");
-      tft.print(retry + 1);
-      WiFi.disconnect();
-      delay(1000);
-    }
-    WiFi.begin(wifiSSID, wifiPassword);
-
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < WIFI_CONNECT_ATTEMPTS) {
-      delay(WIFI_CONNECT_DELAY_MS);
-      yield();  // Prevent WDT timeout during long connection wait
-      tft.print(".");
-      attempts++;
-    }
-    if (WiFi.status() == WL_CONNECTED) break;
+  // Cached access point first; the full path (scan + DHCP) if that fails
+  wifiRound = 0;
+  if (beginFastConnect()) {
+    drawWiFiProgress("WiFi: connecting");
+    setWiFiConnState(WIFI_CONN_FAST);
+  } else {
+    beginWiFiRound();
   }
+}
 
-  if (WiFi.status() == WL_CONNECTED) {
-    tft.println("OK");
-    tft.setCursor(10, wifiY + 18);
-    tft.print("IP: ");
-    tft.println(WiFi.localIP());
-    wifiWasConnected = true;
+// Forward declaration
+void checkWiFiConnection();
+
+// Called from loop(): advance the bring-up, then watch the connection
+void updateWiFiConnection() {
+  unsigned long elapsed = millis() - wifiConnStateAt;
+  switch (wifiConnState) {
+    case WIFI_CONN_FAST:
+      if (WiFi.status() == WL_CONNECTED) {
+        onWiFiConnected(true);
+      } else if (elapsed >= WIFI_FAST_CONNECT_TIMEOUT_MS) {
+        abandonFastConnect();
+        beginWiFiRound();
+      }
+      break;
 
-    // Enable WiFi modem sleep (WIFI_PS_MIN_MODEM) to reduce radio power and heat.
-    // Heartbeat timeout relaxed to 10s (from 3s) to accommodate modem sleep latency.
-    WiFi.setSleep(true);
-
-    // HTTP server setup
-    server.on("/status", HTTP_POST, handleStatus);
-    server.on("/status", HTTP_GET, handleStatusGet);
-    server.on("/health", HTTP_GET, handleHealth);
-    server.on("/lock", HTTP_POST, handleLock);
-    server.on("/unlock", HTTP_POST, handleUnlock);
-    server.on("/lock-mode", HTTP_GET, handleLockModeGet);
-    server.on("/lock-mode", HTTP_POST, handleLockModePost);
-    server.on("/reboot", HTTP_POST, handleReboot);
-
-    // WiFi reset endpoint - requires {"confirm":true} to prevent accidental resets
-    server.on("/wifi-reset", HTTP_POST, []() {
-      if (server.hasArg("plain")) {
-        StaticJsonDocument<64> doc;
-        deserializeJson(doc, server.arg("plain"));
-        if (doc["confirm"] == true) {
-          preferences.begin("vibemon", false);
-          preferences.remove("wifiSSID");
-          preferences.remove("wifiPassword");
-          preferences.end();
-          server.send(200, "application/json", "{\"success\":true,\"message\":\"WiFi credentials cleared. Rebooting...\"}");
-          delay(1000);
-          ESP.restart();
-          return;
+    case WIFI_CONN_JOINING:
+      if (WiFi.status() == WL_CONNECTED) {
+        onWiFiConnected(false);
+      } else if (elapsed >= (unsigned long)WIFI_CONNECT_ATTEMPTS * WIFI_CONNECT_DELAY_MS) {
+        WiFi.disconnect();
+        if (++wifiRound < WIFI_CONNECT_RETRIES) {
+          setWiFiConnState(WIFI_CONN_ROUND_WAIT);
+        } else {
+          // Keep saved credentials so the user can retry without re-entering them
+          drawWiFiProgress("WiFi: Failed", "Starting setup...");
+          Serial.println("{\"wifi\":\"connect_failed\"}");
+          setWiFiConnState(WIFI_CONN_FAILED);
         }
       }
-      server.send(400, "application/json", "{\"error\":\"Requires {\\\"confirm\\\":true}\"}");
-    });
+      break;
 
-    server.begin();
-  } else {
-    tft.println("Failed");
+    case WIFI_CONN_ROUND_WAIT:
+      if (elapsed >= WIFI_ROUND_PAUSE_MS) beginWiFiRound();
+      break;
 
-    // Connection failed after all retries - enter provisioning mode
-    // Keep saved credentials so user can retry without re-entering them
-    tft.setCursor(10, wifiY + 18);
-    tft.println("Starting setup...");
-    delay(WIFI_FAIL_RESTART_MS);
+    case WIFI_CONN_FAILED:
+      if (elapsed >= WIFI_FAIL_RESTART_MS) {
+        setWiFiConnState(WIFI_CONN_IDLE);
+        startProvisioningMode();
+      }
+      break;
 
-    startProvisioningMode();
-    return;
+    case WIFI_CONN_CONNECTED:
+      checkWiFiConnection();
+      break;
+
+    default:
+      break;
   }
 }
 
@@ -416,8 +847,9 @@ void checkWiFiConnection() {
     Serial.print(ESP.getFreeHeap());
     Serial.println("}");
   } else if (currentlyConnected && !wifiWasConnected) {
-    // WiFi recovered
+    // WiFi recovered (possibly through another access point)
     wifiWasConnected = true;
+    saveWiFiCache();
     drawConnectionIndicator();
     Serial.print("{\"wifi\":\"reconnected\",\"ip\":\"");
     Serial.print(WiFi.localIP());
@@ -426,7 +858,7 @@ void checkWiFiConnection() {
     Serial.println("}");
 #ifdef USE_WEBSOCKET
     // Reset backoff and restart WebSocket after WiFi recovery
-    wsReconnectDelay = WS_RECONNECT_INITIAL;
+    wsReconnectDelay = getWsReconnectBase();
     wsDisconnectedSince = 0;
     webSocket.disconnect();
     setupWebSocket();
@@ -439,7 +871,7 @@ void checkWiFiConnection() {
   if (currentlyConnected && !wsConnected && wsDisconnectedSince > 0) {
     if (now - wsDisconnectedSince >= WS_REINIT_TIMEOUT) {
       unsigned long disconnectedMs = now - wsDisconnectedSince;
-      wsReconnectDelay = WS_RECONNECT_INITIAL;
+      wsReconnectDelay = getWsReconnectBase();
       wsDisconnectedSince = now;  // Reset timer to avoid repeated rapid reinit
       Serial.print("{\"websocket\":\"force_reinit\",\"disconnectedMs\":");
       Serial.print(disconnectedMs);
@@ -463,6 +895,8 @@ void checkWiFiConnection() {
 void webSocketEvent(WStype_t type, uint8_t* payload, size_t length);
 
 void setupWebSocket() {
+  initWsHealth();
+
   // Load token from preferences if not already loaded
   if (strlen(wsToken) == 0) {
     loadWebSocketToken();
@@ -489,21 +923,67 @@ void setupWebSocket() {
   webSocket.onEvent(webSocketEvent);
 
   // Set initial reconnect interval (adjusted by exponential backoff)
-  webSocket.setReconnectInterval(wsReconnectDelay);
+  webSocket.setReconnectInterval(jitterWsDelay(wsReconnectDelay));
 
-  // Enable heartbeat to detect stale connections
-  // Ping every 30s, timeout after 10s, disconnect after 2 missed pongs
-  webSocket.enableHeartbeat(WS_HEARTBEAT_INTERVAL, WS_HEARTBEAT_TIMEOUT, WS_HEARTBEAT_FAILURES);
+  // Heartbeat is driven by updateWsHeartbeat() (timing adapted to the link)
+  webSocket.disableHeartbeat();
 
   Serial.print("{\"websocket\":\"connecting\",\"heap\":");
   Serial.print(ESP.getFreeHeap());
   Serial.println("}");
 }
 
+// =============================================================================
+// WebSocket Heartbeat
+// =============================================================================
+
+// Ping after a silence of getWsPingIdle(); a pong must come within
+// getWsPongTimeout(). Pings carry a sequence number so each pong is matched
+// to its ping (clean RTT samples). WS_HEARTBEAT_FAILURES missed pongs in a
+// row drop the connection (the library reconnects).
+void sendWsHeartbeat(unsigned long now) {
+  uint8_t seq[4];
+  wsHealth.pingSeq++;
+  for (int i = 0; i < 4; i++) seq[i] = (wsHealth.pingSeq >> (8 * i)) & 0xFF;
+  if (!webSocket.sendPing(seq, sizeof(seq))) return;
+  wsHealth.pingSentAt = now;
+  wsHealth.pingOutstanding = true;
+  wsHealth.pings++;
+}
+
+// Called from loop() after webSocket.loop()
+void updateWsHeartbeat() {
+  if (!wsConnected) return;
+  unsigned long now = millis();
+  if (!wsHealth.pingOutstanding) {
+    if (now - wsHealth.lastRxAt >= getWsPingIdle()) sendWsHeartbeat(now);
+    return;
+  }
+  if (now - wsHealth.pingSentAt < getWsPongTimeout()) return;
+
+  // Missed pong: back off the timeout (a late pong must not count as a
+  // sample for the next ping), probe again or give up
+  wsHealth.pingOutstanding = false;
+  wsHealth.timeouts++;
+  wsHealth.missed++;
+  if (wsHealth.rtoBackoff < 8) wsHealth.rtoBackoff *= 2;
+  if (wsHealth.missed >= WS_HEARTBEAT_FAILURES) {
+    wsHealth.heartbeatDrops++;
+    Serial.print("{\"websocket\":\"heartbeat_timeout\",\"rtoMs\":");
+    Serial.print((unsigned long)wsHealth.rto);
+    Serial.println("}");
+    webSocket.disconnect();
+    return;
+  }
+  sendWsHeartbeat(now);
+}
+
 void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
   switch (type) {
     case WStype_DISCONNECTED:
+      TRACE_INSTANT(TRACE_WS_DISCONNECT, 0);
       wsConnected = false;
+      noteWsDisconnected(millis());
       if (wsDisconnectedSince == 0) wsDisconnectedSince = millis();
       if (wsConsecutiveFailures < 255) wsConsecutiveFailures++;
       drawConnectionIndicator();
@@ -516,7 +996,7 @@ void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
         unsigned long newDelay = (unsigned long)(wsReconnectDelay * WS_RECONNECT_MULTIPLIER);
         wsReconnectDelay = (newDelay > WS_RECONNECT_MAX) ? WS_RECONNECT_MAX : newDelay;
       }
-      webSocket.setReconnectInterval(wsReconnectDelay);
+      webSocket.setReconnectInterval(jitterWsDelay(wsReconnectDelay));
       Serial.print("{\"websocket\":\"disconnected\",\"failures\":");
       Serial.print(wsConsecutiveFailures);
       Serial.print(",\"nextRetry\":");
@@ -527,13 +1007,16 @@ void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
       break;
 
     case WStype_CONNECTED:
+      TRACE_INSTANT(TRACE_WS_CONNECT, 0);
       wsConnected = true;
+      wsConnectionId++;
       wsDisconnectedSince = 0;  // Clear disconnect timestamp
       wsConsecutiveFailures = 0;  // Reset failure counter on successful connection
+      noteWsConnected(millis());
       drawConnectionIndicator();
       // Reset backoff on successful connection
-      wsReconnectDelay = WS_RECONNECT_INITIAL;
-      webSocket.setReconnectInterval(wsReconnectDelay);
+      wsReconnectDelay = getWsReconnectBase();
+      webSocket.setReconnectInterval(jitterWsDelay(wsReconnectDelay));
       Serial.print("{\"websocket\":\"connected\",\"url\":\"");
       Serial.print((char*)payload);
       Serial.print("\",\"heap\":");
@@ -542,7 +1025,7 @@ void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
 
       // Send authentication message if token is configured
       if (strlen(wsToken) > 0) {
-        char authMsg[128];
+        char authMsg[sizeof(wsToken) + 32];
         snprintf(authMsg, sizeof(authMsg), "{\"type\":\"auth\",\"token\":\"%s\"}", wsToken);
         webSocket.sendTXT(authMsg);
         Serial.println("{\"websocket\":\"auth_sent\"}");
@@ -550,8 +1033,23 @@ void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
       break;
 
     case WStype_TEXT:
+      TRACE_INSTANT(TRACE_INPUT, INPUT_WEBSOCKET);
+      noteWsReceived(millis(), true);
       // Process received message (same as Serial/HTTP input)
-      processInput((char*)payload);
+      processInput((char*)payload, INPUT_WEBSOCKET, wsConnectionId);
+      break;
+
+    case WStype_PONG: {
+      uint32_t seq = 0;
+      if (length == 4) {
+        seq = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+      }
+      noteWsPong(millis(), seq);
+      break;
+    }
+
+    case WStype_PING:  // Relay's own heartbeat (the library answers it)
+      noteWsReceived(millis(), false);
       break;
 
     case WStype_ERROR:
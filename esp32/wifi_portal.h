@@ -166,7 +166,9 @@ const char CONFIG_PAGE[] = R"HTML(
       status.style.display = 'block';
     }
 
-    function scanNetworks() {
+    // The device scans in the background and answers with its cached list:
+    // show it, and ask again until the scan in progress is done
+    function scanNetworks(retries = 10) {
       const scanBtn = document.querySelector('.scan-btn');
       const scanText = document.getElementById('scan-text');
       scanBtn.disabled = true;
@@ -176,6 +178,7 @@ const char CONFIG_PAGE[] = R"HTML(
         .then(res => res.json())
         .then(data => {
           const select = document.getElementById('ssid');
+          const selected = select.value;
           select.innerHTML = '<option value="">Select a network...</option>';
 
           data.networks.forEach(network => {
@@ -186,16 +189,21 @@ const char CONFIG_PAGE[] = R"HTML(
             option.textContent = signal + ' ' + network.ssid + ' ' + lock;
             select.appendChild(option);
           });
+          select.value = selected;
 
+          if (data.scanning && retries > 0) {
+            setTimeout(() => scanNetworks(retries - 1), 1000);
+            return;
+          }
           showStatus('Found ' + data.networks.length + ' networks');
           setTimeout(() => {
             document.getElementById('status').style.display = 'none';
           }, 3000);
+          scanBtn.disabled = false;
+          scanText.innerHTML = '🔍 Scan Networks';
         })
         .catch(err => {
           showStatus('Scan failed: ' + err.message, true);
-        })
-        .finally(() => {
           scanBtn.disabled = false;
           scanText.innerHTML = '🔍 Scan Networks';
         });
@@ -243,7 +251,7 @@ const char CONFIG_PAGE[] = R"HTML(
 
     // Auto-scan on load
     window.addEventListener('load', () => {
-      setTimeout(scanNetworks, 500);
+      setTimeout(() => scanNetworks(), 500);
     });
   </script>
 </body>
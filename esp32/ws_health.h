@@ -0,0 +1,174 @@
+/*
+ * VibeMon WebSocket Health
+ * Liveness estimates for the relay connection, measured instead of fixed:
+ * ping/pong round-trip time smoothed like TCP's RTO (RFC 6298), the gaps
+ * between received messages, and how long reconnects take. The heartbeat
+ * and reconnect policy in wifi_manager.h are derived from them.
+ */
+
+#ifndef WS_HEALTH_H
+#define WS_HEALTH_H
+
+#if defined(USE_WIFI) && defined(USE_WEBSOCKET)
+
+// Reconnect time histogram: disconnected to connected again, upper bounds (ms)
+#define WS_RECONNECT_BUCKETS 6
+const unsigned long WS_RECONNECT_BOUNDS[WS_RECONNECT_BUCKETS - 1] = { 1000, 3000, 10000, 30000, 120000 };
+
+struct WsHealth {
+  // Round-trip time (ms, 0 = no sample yet). Kept across reconnects: the
+  // path to the relay rarely changes.
+  uint32_t srtt;
+  uint32_t rttvar;
+  uint32_t rto;             // Pong timeout
+  uint32_t rtoBackoff;      // Doubled per missed pong (Karn), reset by the latest ping's pong
+
+  // Received-message gaps (ms, EWMA like the RTT)
+  uint32_t gapAvg;
+  uint32_t gapDev;
+  unsigned long lastRxAt;
+
+  // Heartbeat in flight
+  uint32_t pingSeq;
+  unsigned long pingSentAt;
+  bool pingOutstanding;
+  uint8_t missed;           // Consecutive missed pongs
+
+  uint32_t pings;
+  uint32_t pongs;
+  uint32_t timeouts;        // Missed pongs
+  uint32_t heartbeatDrops;  // Disconnects by the heartbeat
+
+  unsigned long disconnectedAt;  // 0 = connected, or never connected
+  uint32_t reconnects[WS_RECONNECT_BUCKETS];
+};
+
+WsHealth wsHealth = {};
+
+// Timeouts before the first sample (called from setupWebSocket(); a
+// re-init keeps what was measured)
+void initWsHealth() {
+  if (wsHealth.rto == 0) wsHealth.rto = WS_RTO_INITIAL;
+  if (wsHealth.rtoBackoff == 0) wsHealth.rtoBackoff = 1;
+}
+
+uint32_t clampWsMs(uint32_t value, uint32_t lo, uint32_t hi) {
+  return value < lo ? lo : (value > hi ? hi : value);
+}
+
+// RTO = SRTT + 4 x RTTVAR (alpha 1/8, beta 1/4), within WS_RTO_MIN..MAX
+void addWsRttSample(uint32_t rtt) {
+  if (wsHealth.srtt == 0) {
+    wsHealth.srtt = rtt > 0 ? rtt : 1;
+    wsHealth.rttvar = rtt / 2;
+  } else {
+    uint32_t err = rtt > wsHealth.srtt ? rtt - wsHealth.srtt : wsHealth.srtt - rtt;
+    wsHealth.rttvar = (3 * wsHealth.rttvar + err) / 4;
+    wsHealth.srtt = (7 * wsHealth.srtt + rtt) / 8;
+  }
+  wsHealth.rto = clampWsMs(wsHealth.srtt + 4 * wsHealth.rttvar, WS_RTO_MIN, WS_RTO_MAX);
+}
+
+// Pong timeout for the next ping (backed off after misses)
+uint32_t getWsPongTimeout() {
+  return clampWsMs(wsHealth.rto * wsHealth.rtoBackoff, WS_RTO_MIN, WS_RTO_MAX);
+}
+
+// Silence after which the link is probed: a few RTOs, or sooner when the
+// relay usually talks more often than that (a gap well beyond its usual
+// ones is suspicious). Within WS_PING_IDLE_MIN..MAX.
+uint32_t getWsPingIdle() {
+  uint32_t idle = wsHealth.rto * WS_PING_IDLE_RTO_FACTOR;
+  if (wsHealth.gapAvg > 0) {
+    uint32_t gapLimit = wsHealth.gapAvg + 4 * wsHealth.gapDev;
+    if (gapLimit < idle) idle = gapLimit;
+  }
+  return clampWsMs(idle, WS_PING_IDLE_MIN, WS_PING_IDLE_MAX);
+}
+
+// Any frame from the relay (message or pong): the link is alive
+void noteWsReceived(unsigned long now, bool message) {
+  if (message && wsHealth.lastRxAt != 0) {
+    uint32_t gap = now - wsHealth.lastRxAt;
+    if (wsHealth.gapAvg == 0) {
+      wsHealth.gapAvg = gap > 0 ? gap : 1;
+      wsHealth.gapDev = gap / 2;
+    } else {
+      uint32_t err = gap > wsHealth.gapAvg ? gap - wsHealth.gapAvg : wsHealth.gapAvg - gap;
+      wsHealth.gapDev = (3 * wsHealth.gapDev + err) / 4;
+      wsHealth.gapAvg = (7 * wsHealth.gapAvg + gap) / 8;
+    }
+  }
+  wsHealth.lastRxAt = now;
+  wsHealth.missed = 0;
+}
+
+// Pong for ping `seq` (0: no payload, or not ours). Only a pong for the
+// latest ping gives an unambiguous sample and ends it: a late pong for one
+// that already timed out is just traffic (the retry and its backoff stand).
+void noteWsPong(unsigned long now, uint32_t seq) {
+  wsHealth.pongs++;
+  if (wsHealth.pingOutstanding && seq == wsHealth.pingSeq) {
+    addWsRttSample(now - wsHealth.pingSentAt);
+    wsHealth.pingOutstanding = false;
+    wsHealth.rtoBackoff = 1;
+  }
+  noteWsReceived(now, false);
+}
+
+void noteWsConnected(unsigned long now) {
+  if (wsHealth.disconnectedAt != 0) {
+    unsigned long took = now - wsHealth.disconnectedAt;
+    int bucket = 0;
+    while (bucket < WS_RECONNECT_BUCKETS - 1 && took > WS_RECONNECT_BOUNDS[bucket]) bucket++;
+    wsHealth.reconnects[bucket]++;
+  }
+  wsHealth.disconnectedAt = 0;
+  wsHealth.lastRxAt = now;
+  wsHealth.pingOutstanding = false;
+  wsHealth.missed = 0;
+  wsHealth.rtoBackoff = 1;
+}
+
+void noteWsDisconnected(unsigned long now) {
+  if (wsHealth.disconnectedAt == 0) wsHealth.disconnectedAt = now ? now : 1;
+  wsHealth.pingOutstanding = false;
+}
+
+// First reconnect delay: proportional to the RTO (quick on a fast link),
+// within WS_RECONNECT_MIN..WS_RECONNECT_INITIAL
+unsigned long getWsReconnectBase() {
+  return clampWsMs(2 * wsHealth.rto, WS_RECONNECT_MIN, WS_RECONNECT_INITIAL);
+}
+
+// Equal jitter: half the delay fixed, half random, so devices that lost
+// the relay together don't reconnect in lockstep
+unsigned long jitterWsDelay(unsigned long delayMs) {
+  unsigned long half = delayMs / 2;
+  return half + esp_random() % (half + 1);
+}
+
+// Metrics JSON object for GET /metrics
+int writeWsHealthJson(char* buf, size_t size) {
+  size_t len = snprintf(buf, size,
+    "{\"connected\":%s,\"srttMs\":%lu,\"rttvarMs\":%lu,\"rtoMs\":%lu,\"pingIdleMs\":%lu,"
+    "\"gapMs\":%lu,\"gapDevMs\":%lu,\"pings\":%lu,\"pongs\":%lu,\"missedPongs\":%lu,"
+    "\"heartbeatDrops\":%lu,\"reconnectDelayMs\":%lu,\"reconnectMs\":{",
+    wsConnected ? "true" : "false",
+    (unsigned long)wsHealth.srtt, (unsigned long)wsHealth.rttvar, (unsigned long)wsHealth.rto,
+    (unsigned long)getWsPingIdle(), (unsigned long)wsHealth.gapAvg, (unsigned long)wsHealth.gapDev,
+    (unsigned long)wsHealth.pings, (unsigned long)wsHealth.pongs, (unsigned long)wsHealth.timeouts,
+    (unsigned long)wsHealth.heartbeatDrops, wsReconnectDelay);
+  for (int i = 0; i < WS_RECONNECT_BUCKETS && len < size; i++) {
+    if (i < WS_RECONNECT_BUCKETS - 1) {
+      len += snprintf(buf + len, size - len, "\"le%lu\":%lu,", WS_RECONNECT_BOUNDS[i], (unsigned long)wsHealth.reconnects[i]);
+    } else {
+      len += snprintf(buf + len, size - len, "\"more\":%lu}}", (unsigned long)wsHealth.reconnects[i]);
+    }
+  }
+  return len < size ? (int)len : (int)size - 1;
+}
+
+#endif // USE_WIFI && USE_WEBSOCKET
+
+#endif // WS_HEALTH_H
@@ -0,0 +1,171 @@
+/*
+ * VibeMon LAN WebSocket Server
+ * Local clients (desktop app, dashboards) connect straight to the device
+ * instead of going through the cloud relay. They send the same messages as
+ * the relay or POST /status, and may subscribe to state pushes instead of
+ * polling GET /status. Enabled with USE_WS_SERVER (requires USE_WIFI).
+ */
+
+#ifndef WS_SERVER_H
+#define WS_SERVER_H
+
+#if defined(USE_WIFI) && defined(USE_WS_SERVER)
+
+// =============================================================================
+// Connections
+// =============================================================================
+
+// Each connection's outbound channel holds only the latest state: a slow
+// subscriber gets the newest snapshot when it catches up, never a backlog
+struct WsLanClient {
+  bool connected;
+  bool subscribed;
+  uint32_t sentSeq;  // statusSeq last pushed to this client
+};
+
+WebSocketsServer wsServer(WS_SERVER_PORT);
+WsLanClient wsLanClients[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+// Push the current snapshot to one client
+void sendWsStatusEvent(uint8_t num) {
+  char msg[STATUS_EVENT_SIZE + 40];
+  snprintf(msg, sizeof(msg), "{\"type\":\"state\",\"seq\":%lu,%s}", (unsigned long)statusSeq, statusEvent);
+  wsServer.sendTXT(num, msg);
+  wsLanClients[num].sentSeq = statusSeq;
+}
+
+// =============================================================================
+// Command Replies
+// =============================================================================
+
+// Collects what a command prints (commandReply) and sends each line to the
+// client that sent it as one text frame. A line too long for the buffer is
+// replaced by an error.
+class WsLanReply : public Print {
+ public:
+  void begin(uint8_t client) {
+    num = client;
+    len = 0;
+    overflow = false;
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      sendLine();
+    } else if (c != '\r') {
+      if (len < sizeof(line) - 1) {
+        line[len++] = (char)c;
+      } else {
+        overflow = true;
+      }
+    }
+    return 1;
+  }
+
+  // Send what is buffered (also called after the command, for output
+  // without a trailing newline)
+  void sendLine() {
+    if (overflow) {
+      wsServer.sendTXT(num, "{\"error\":\"Reply too large\"}");
+    } else if (len > 0) {
+      line[len] = '\0';
+      wsServer.sendTXT(num, line, len);
+    }
+    len = 0;
+    overflow = false;
+  }
+
+ private:
+  uint8_t num = 0;
+  char line[WS_SERVER_REPLY_SIZE];
+  size_t len = 0;
+  bool overflow = false;
+};
+
+WsLanReply wsLanReply;
+
+// {"type":"subscribe"} / {"type":"unsubscribe"} (routed here by handleWebSocketMessage)
+void setWsSubscription(uint32_t num, bool subscribed) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || !wsLanClients[num].connected) return;
+  wsLanClients[num].subscribed = subscribed;
+  if (subscribed) {
+    refreshStatusEvent();
+    sendWsStatusEvent((uint8_t)num);  // Current state first, then changes
+  }
+}
+
+void wsServerEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+  switch (type) {
+    case WStype_CONNECTED:
+      wsLanClients[num] = WsLanClient{true, false, 0};
+      Serial.print("{\"wsServer\":\"connected\",\"client\":");
+      Serial.print(num);
+      Serial.print(",\"ip\":\"");
+      Serial.print(wsServer.remoteIP(num));
+      Serial.println("\"}");
+      break;
+
+    case WStype_DISCONNECTED:
+      wsLanClients[num] = WsLanClient{false, false, 0};
+      Serial.print("{\"wsServer\":\"disconnected\",\"client\":");
+      Serial.print(num);
+      Serial.println("}");
+      break;
+
+    case WStype_TEXT:
+      TRACE_INSTANT(TRACE_INPUT, INPUT_WEBSOCKET_LAN);
+      // Same path as the relay connection; the client number is the source
+      // ID. Command replies go back to this client instead of Serial.
+      wsLanReply.begin(num);
+      commandReply = &wsLanReply;
+      processInput((char*)payload, INPUT_WEBSOCKET_LAN, num);
+      commandReply = &Serial;
+      wsLanReply.sendLine();
+      break;
+
+    default:
+      break;
+  }
+}
+
+// =============================================================================
+// Server
+// =============================================================================
+
+void beginWsServer() {
+  wsServer.begin();
+  wsServer.onEvent(wsServerEvent);
+  // Drop clients that vanished without closing (frees the slot)
+  wsServer.enableHeartbeat(WS_SERVER_PING_MS, WS_SERVER_PONG_TIMEOUT_MS, WS_SERVER_PING_FAILURES);
+  Serial.print("{\"wsServer\":\"listening\",\"port\":");
+  Serial.print(WS_SERVER_PORT);
+  Serial.println("}");
+}
+
+// Called from loop() with the other transports: accept and read clients
+void pollWsServer() {
+  wsServer.loop();
+}
+
+// Called from loop() once queued updates are applied: push the state to
+// subscribers that haven't seen it. The snapshot is only rebuilt while
+// someone is subscribed.
+void pushWsServerUpdates() {
+  bool anySubscribed = false;
+  for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (wsLanClients[i].subscribed) anySubscribed = true;
+  }
+  if (!anySubscribed) return;
+
+  refreshStatusEvent();
+  for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (wsLanClients[i].subscribed && wsLanClients[i].sentSeq != statusSeq) {
+      sendWsStatusEvent((uint8_t)i);
+    }
+  }
+}
+
+#endif // USE_WIFI && USE_WS_SERVER
+
+#endif // WS_SERVER_H
@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""
+ESP32 HTTP Keep-Alive Benchmark
+Sends status updates to a VibeMon ESP32 (or the desktop app) over HTTP and
+compares a new connection per update, one persistent connection, and
+pipelined requests on a persistent connection.
+
+Usage:
+    python http_keepalive_bench.py http://192.168.0.185
+    python http_keepalive_bench.py http://192.168.0.185 --count 300 --depth 8
+    python http_keepalive_bench.py http://127.0.0.1:19280 --modes close,keepalive --json report.json
+
+Modes:
+    close       new TCP connection per update (what a hook script does)
+    keepalive   one persistent connection, one request at a time
+    pipeline    one persistent connection, --depth requests sent back to back
+                before reading their responses
+
+Per mode: requests/s, applied updates/s, and median/p95/max latency from
+sending a request to reading its response. The device rate-limits HTTP
+status updates per IP (10/s, burst 20 by default): throttled requests (429)
+still take the full request path and are counted separately. Use --rate to
+stay under the limit, or raise RATE_LIMIT_HTTP_RATE in esp32/config.h.
+"""
+
+import argparse
+import http.client
+import json
+import socket
+import sys
+import time
+import urllib.parse
+
+STATES = ["thinking", "working", "working", "working", "done"]
+TOOLS = ["Read", "Edit", "Bash", "Grep"]
+
+
+# =============================================================================
+# Requests
+# =============================================================================
+
+class Payloads:
+    """Status updates with a distinct eventId each (never de-duplicated)."""
+
+    def __init__(self):
+        self.run_id = int(time.time())
+        self.n = 0
+
+    def next(self):
+        self.n += 1
+        state = STATES[self.n % len(STATES)]
+        payload = {
+            "state": state,
+            "project": "keepalive-bench",
+            "eventId": f"bench-{self.run_id}-{self.n}",
+        }
+        if state == "working":
+            payload["tool"] = TOOLS[self.n % len(TOOLS)]
+        return json.dumps(payload, separators=(",", ":")).encode()
+
+
+def request_bytes(host, body, close):
+    head = (f"POST /status HTTP/1.1\r\nHost: {host}\r\n"
+            f"Content-Type: application/json\r\nContent-Length: {len(body)}\r\n")
+    if close:
+        head += "Connection: close\r\n"
+    return head.encode() + b"\r\n" + body
+
+
+def read_response(reader):
+    """Read one response from a buffered socket reader: (status, body)."""
+    status_line = reader.readline()
+    if not status_line:
+        raise ConnectionError("Connection closed by device")
+    status = int(status_line.split()[1])
+    length = 0
+    while True:
+        line = reader.readline()
+        if line in (b"\r\n", b"\n", b""):
+            break
+        name, _, value = line.decode("latin-1").partition(":")
+        if name.strip().lower() == "content-length":
+            length = int(value.strip())
+    return status, reader.read(length)
+
+
+def classify(status, body):
+    if status == 429:
+        return "throttled"
+    if status != 200:
+        return f"http{status}"
+    try:
+        result = json.loads(body)
+    except ValueError:
+        return "invalid"
+    if result.get("duplicate"):
+        return "duplicate"
+    return "applied" if result.get("success") else "blocked"
+
+
+# =============================================================================
+# Modes
+# =============================================================================
+
+def run_close(target, payloads, count, pace):
+    """New connection per request."""
+    latencies, outcomes = [], {}
+    for i in range(count):
+        pace(i)
+        start = time.monotonic()
+        conn = http.client.HTTPConnection(target.hostname, target.port or 80, timeout=10)
+        conn.request("POST", "/status", payloads.next(),
+                     {"Content-Type": "application/json", "Connection": "close"})
+        response = conn.getresponse()
+        body = response.read()
+        conn.close()
+        latencies.append(time.monotonic() - start)
+        outcome = classify(response.status, body)
+        outcomes[outcome] = outcomes.get(outcome, 0) + 1
+    return latencies, outcomes
+
+
+def run_pipelined(target, payloads, count, pace, depth):
+    """Persistent connection, `depth` requests in flight (1 = plain keep-alive)."""
+    latencies, outcomes, reconnects = [], {}, 0
+    sock = reader = None
+    sent = 0
+    while sent < count:
+        if sock is None:
+            sock = socket.create_connection((target.hostname, target.port or 80), timeout=10)
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            reader = sock.makefile("rb")
+        window = min(depth, count - sent)
+        pace(sent)
+        start = time.monotonic()
+        sock.sendall(b"".join(request_bytes(target.netloc, payloads.next(), False) for _ in range(window)))
+        answered = 0
+        try:
+            for _ in range(window):
+                status, body = read_response(reader)
+                latencies.append(time.monotonic() - start)
+                outcome = classify(status, body)
+                outcomes[outcome] = outcomes.get(outcome, 0) + 1
+                answered += 1
+        except (ConnectionError, OSError):
+            # Closed by the device (idle timeout, request quota, slot taken
+            # over): the unanswered requests are lost, reconnect
+            outcomes["lost"] = outcomes.get("lost", 0) + window - answered
+            reconnects += 1
+            reader.close()
+            sock.close()
+            sock = None
+        sent += window
+    if sock is not None:
+        reader.close()
+        sock.close()
+    return latencies, outcomes, reconnects
+
+
+# =============================================================================
+# Report
+# =============================================================================
+
+def percentile(values, percent):
+    values = sorted(values)
+    index = min(len(values) - 1, max(0, (len(values) * percent + 99) // 100 - 1))
+    return values[index]
+
+
+def summarize(mode, latencies, outcomes, seconds, reconnects=0):
+    applied = outcomes.get("applied", 0)
+    return {
+        "mode": mode,
+        "requests": len(latencies),
+        "seconds": round(seconds, 3),
+        "requestsPerSec": round(len(latencies) / seconds, 1) if seconds > 0 else 0,
+        "appliedPerSec": round(applied / seconds, 1) if seconds > 0 else 0,
+        "p50Ms": round(percentile(latencies, 50) * 1000, 2) if latencies else None,
+        "p95Ms": round(percentile(latencies, 95) * 1000, 2) if latencies else None,
+        "maxMs": round(max(latencies) * 1000, 2) if latencies else None,
+        "outcomes": outcomes,
+        "reconnects": reconnects,
+    }
+
+
+def print_report(results, args):
+    pacing = f"at {args.rate}/s" if args.rate else "back to back"
+    print(f"\n{args.count} updates per mode, {pacing}, pipeline depth {args.depth}")
+    print(f"\n{'mode':12}{'req/s':>9}{'applied/s':>11}{'p50 ms':>9}{'p95 ms':>9}{'max ms':>9}  outcomes")
+    for r in results:
+        outcomes = ", ".join(f"{k} {v}" for k, v in sorted(r["outcomes"].items()))
+        if r["reconnects"]:
+            outcomes += f" ({r['reconnects']} reconnects)"
+        print(f"{r['mode']:12}{r['requestsPerSec']:>9}{r['appliedPerSec']:>11}"
+              f"{r['p50Ms']:>9}{r['p95Ms']:>9}{r['maxMs']:>9}  {outcomes}")
+
+    base = next((r for r in results if r["mode"] == "close"), None)
+    if base and base["p50Ms"]:
+        for r in results:
+            if r is not base and r["p50Ms"]:
+                print(f"{r['mode']} vs close: median latency {r['p50Ms'] / base['p50Ms']:.2f}x, "
+                      f"requests/s {r['requestsPerSec'] / max(base['requestsPerSec'], 0.1):.2f}x")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="VibeMon HTTP keep-alive benchmark")
+    parser.add_argument("url", help="device base URL, e.g. http://192.168.0.185")
+    parser.add_argument("--count", type=int, default=200, help="updates per mode (default 200)")
+    parser.add_argument("--rate", type=float, default=0, help="requests per second, 0 = unpaced")
+    parser.add_argument("--depth", type=int, default=4, help="pipelined requests in flight (default 4)")
+    parser.add_argument("--modes", default="close,keepalive,pipeline", help="modes to run, comma separated")
+    parser.add_argument("--pause", type=float, default=2.0,
+                        help="seconds between modes, lets the rate limit refill (default 2)")
+    parser.add_argument("--json", metavar="FILE", help="also write the results as JSON")
+    args = parser.parse_args()
+
+    target = urllib.parse.urlsplit(args.url)
+    if target.scheme != "http" or not target.hostname:
+        parser.error("URL must be http://host[:port]")
+
+    payloads = Payloads()
+    results = []
+    for n, mode in enumerate(m.strip() for m in args.modes.split(",")):
+        if n > 0:
+            time.sleep(args.pause)
+        start = time.monotonic()
+
+        def pace(i):
+            if args.rate:
+                time.sleep(max(0.0, start + i / args.rate - time.monotonic()))
+
+        if mode == "close":
+            latencies, outcomes = run_close(target, payloads, args.count, pace)
+            reconnects = 0
+        elif mode == "keepalive":
+            latencies, outcomes, reconnects = run_pipelined(target, payloads, args.count, pace, 1)
+        elif mode == "pipeline":
+            latencies, outcomes, reconnects = run_pipelined(target, payloads, args.count, pace, max(1, args.depth))
+        else:
+            parser.error(f"unknown mode {mode}")
+        results.append(summarize(mode, latencies, outcomes, time.monotonic() - start, reconnects))
+
+    print_report(results, args)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=2)
+        print(f"\nResults written to {args.json}")
+    sys.exit(0 if all(r["requests"] for r in results) else 1)
+
+
+if __name__ == "__main__":
+    main()
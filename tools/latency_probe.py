@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""
+ESP32 Latency Probe Load Generator
+Sends status updates carrying probe IDs to a VibeMon ESP32 and reports how long
+each took to reach the panel (hook to glass), using the device's probe results.
+
+Usage:
+    python latency_probe.py --http http://192.168.0.185
+    python latency_probe.py --serial /dev/ttyACM0 --count 500 --rate 20
+    python latency_probe.py --http http://192.168.0.185 --projects 3 --json report.json
+
+Transports: HTTP (POST /status) or USB Serial (Linux/macOS). WebSocket is
+pushed by the relay, not by this tool; its histogram is in the device report.
+
+End-to-end estimate = one-way transfer + device receive-to-flush, where the
+one-way transfer is half the HTTP round trip, or the Serial line time.
+"""
+
+import argparse
+import json
+import os
+import select
+import sys
+import termios
+import threading
+import time
+import urllib.error
+import urllib.request
+
+STATES = ["thinking", "planning", "working", "working", "done"]
+TOOLS = ["Read", "Edit", "Bash", "Grep"]
+
+
+# =============================================================================
+# Transports
+# =============================================================================
+
+class HttpDevice:
+    """Device reached over HTTP."""
+
+    def __init__(self, base_url):
+        self.base_url = base_url.rstrip("/")
+
+    def request(self, method, path, body=None):
+        data = json.dumps(body).encode() if body is not None else None
+        req = urllib.request.Request(self.base_url + path, data=data, method=method,
+                                     headers={"Content-Type": "application/json"})
+        with urllib.request.urlopen(req, timeout=5) as response:
+            return response.read()
+
+    def send_status(self, payload):
+        """Returns the one-way transfer estimate (s)."""
+        start = time.monotonic()
+        try:
+            self.request("POST", "/status", payload)
+        except urllib.error.HTTPError:
+            pass  # 429 throttled: the device reports the outcome
+        return (time.monotonic() - start) / 2
+
+    def reset(self):
+        self.request("DELETE", "/latency")
+
+    def fetch_latency(self):
+        return json.loads(self.request("GET", "/latency"))
+
+
+class SerialDevice:
+    """Device reached over USB Serial (raw tty, 115200 baud)."""
+
+    BAUD = 115200
+
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[0] = 0                                             # iflag
+        attrs[1] = 0                                             # oflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL  # cflag
+        attrs[3] = 0                                             # lflag
+        attrs[4] = attrs[5] = termios.B115200
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+        self.buffer = b""
+        self.reports = []
+        self.lock = threading.Lock()
+        threading.Thread(target=self.read_loop, daemon=True).start()
+
+    def read_loop(self):
+        while True:
+            ready, _, _ = select.select([self.fd], [], [], 0.5)
+            if not ready:
+                continue
+            self.buffer += os.read(self.fd, 4096)
+            while b"\n" in self.buffer:
+                line, self.buffer = self.buffer.split(b"\n", 1)
+                if line.startswith(b'{"transports"'):
+                    with self.lock:
+                        self.reports.append(json.loads(line))
+
+    def write_line(self, obj):
+        line = (json.dumps(obj, separators=(",", ":")) + "\n").encode()
+        os.write(self.fd, line)
+        return len(line)
+
+    def send_status(self, payload):
+        return self.write_line(payload) * 10 / self.BAUD  # 8N1: 10 bits per byte
+
+    def reset(self):
+        self.write_line({"command": "latency", "reset": True})
+        time.sleep(0.2)
+
+    def fetch_latency(self):
+        with self.lock:
+            count = len(self.reports)
+        self.write_line({"command": "latency"})
+        deadline = time.monotonic() + 3
+        while time.monotonic() < deadline:
+            with self.lock:
+                if len(self.reports) > count:
+                    return self.reports[-1]
+            time.sleep(0.05)
+        raise TimeoutError("No latency report from device")
+
+
+# =============================================================================
+# Report
+# =============================================================================
+
+def percentile(values, percent):
+    if not values:
+        return None
+    values = sorted(values)
+    index = min(len(values) - 1, max(0, (len(values) * percent + 99) // 100 - 1))
+    return values[index]
+
+
+def summarize(values):
+    """Summary in ms."""
+    if not values:
+        return None
+    return {
+        "count": len(values),
+        "avgMs": round(sum(values) / len(values) / 1000, 2),
+        "p50Ms": round(percentile(values, 50) / 1000, 2),
+        "p95Ms": round(percentile(values, 95) / 1000, 2),
+        "p99Ms": round(percentile(values, 99) / 1000, 2),
+        "maxMs": round(max(values) / 1000, 2),
+    }
+
+
+def collect(device, probes, results):
+    """Merge the device's recent probe results into results (by probe ID)."""
+    report = device.fetch_latency()
+    for probe_id, ts, source, outcome, parse_us, glass_us in report["probes"]:
+        if probe_id in probes and probe_id not in results:
+            results[probe_id] = {"source": source, "outcome": outcome,
+                                 "parseUs": parse_us, "glassUs": glass_us}
+    return report
+
+
+def run(device, args):
+    run_id = int(time.time())
+    probes = {}   # probe ID -> one-way estimate (us)
+    results = {}
+    interval = 1.0 / args.rate
+    start = time.monotonic()
+    last_collect = start
+
+    device.reset()
+    for i in range(args.count):
+        probe_id = i + 1
+        state = STATES[i % len(STATES)]
+        payload = {
+            "state": state,
+            "project": f"latency-probe-{i % args.projects}" if args.projects > 1 else "latency-probe",
+            "probe": probe_id,
+            "ts": int((time.monotonic() - start) * 1000),
+            "eventId": f"probe-{run_id}-{probe_id}",  # Distinct events: never de-duplicated
+        }
+        if state == "working":
+            payload["tool"] = TOOLS[i % len(TOOLS)]
+        probes[probe_id] = device.send_status(payload) * 1e6
+
+        # The device keeps only recent results: collect as we go
+        now = time.monotonic()
+        if now - last_collect >= args.collect_interval:
+            collect(device, probes, results)
+            last_collect = now
+        time.sleep(max(0.0, start + (i + 1) * interval - time.monotonic()))
+
+    time.sleep(0.5)  # Let the last frames flush
+    device_report = collect(device, probes, results)
+
+    outcomes = {}
+    parse, glass, e2e = [], [], []
+    for probe_id, one_way in probes.items():
+        result = results.get(probe_id)
+        outcome = result["outcome"] if result else "missing"
+        outcomes[outcome] = outcomes.get(outcome, 0) + 1
+        if result:
+            parse.append(result["parseUs"])
+        if result and outcome == "shown":
+            glass.append(result["glassUs"])
+            e2e.append(one_way + result["glassUs"])
+
+    return {
+        "sent": args.count,
+        "rate": args.rate,
+        "outcomes": outcomes,
+        "deviceParse": summarize(parse),
+        "deviceGlass": summarize(glass),
+        "endToEnd": summarize(e2e),
+        "device": device_report["transports"],
+    }
+
+
+def print_report(report, transport):
+    print(f"\n{report['sent']} probes at {report['rate']}/s over {transport}")
+    print("Outcomes: " + ", ".join(f"{k} {v}" for k, v in sorted(report["outcomes"].items())))
+    print(f"\n{'':24}{'count':>7}{'avg':>9}{'p50':>9}{'p95':>9}{'p99':>9}{'max':>9}  (ms)")
+    for label, key in [("receive -> parsed", "deviceParse"),
+                       ("receive -> glass", "deviceGlass"),
+                       ("end to end (est.)", "endToEnd")]:
+        s = report[key]
+        if s:
+            print(f"{label:24}{s['count']:>7}{s['avgMs']:>9}{s['p50Ms']:>9}"
+                  f"{s['p95Ms']:>9}{s['p99Ms']:>9}{s['maxMs']:>9}")
+        else:
+            print(f"{label:24}{0:>7}")
+
+    print("\nDevice histograms, receive -> glass (all senders):")
+    for name, transport_stats in report["device"].items():
+        g = transport_stats["glass"]
+        if g["count"]:
+            print(f"  {name:10} count {g['count']:>6}  p50 {g['p50Us'] / 1000:.1f}ms"
+                  f"  p95 {g['p95Us'] / 1000:.1f}ms  max {g['maxUs'] / 1000:.1f}ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="VibeMon ESP32 input-to-pixel latency probe")
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("--http", metavar="URL", help="device base URL, e.g. http://192.168.0.185")
+    target.add_argument("--serial", metavar="PATH", help="USB serial device, e.g. /dev/ttyACM0")
+    parser.add_argument("--count", type=int, default=200, help="probes to send (default 200)")
+    parser.add_argument("--rate", type=float, default=5, help="probes per second (default 5)")
+    parser.add_argument("--projects", type=int, default=1, help="projects to spread probes over (default 1)")
+    parser.add_argument("--collect-interval", type=float, default=1.0,
+                        help="seconds between result collections (default 1)")
+    parser.add_argument("--json", metavar="FILE", help="also write the report as JSON")
+    args = parser.parse_args()
+
+    device = HttpDevice(args.http) if args.http else SerialDevice(args.serial)
+    report = run(device, args)
+    print_report(report, "HTTP" if args.http else "Serial")
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+        print(f"\nReport written to {args.json}")
+    sys.exit(0 if report["outcomes"].get("shown") else 1)
+
+
+if __name__ == "__main__":
+    main()
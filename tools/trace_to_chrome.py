@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+ESP32 Trace to Chrome Trace Converter
+Converts a binary trace dump (firmware built with USE_TRACE) to Chrome
+trace_event JSON, viewable in chrome://tracing or https://ui.perfetto.dev.
+
+Usage:
+    python trace_to_chrome.py http://192.168.0.185/trace          -> trace.json
+    python trace_to_chrome.py dump.bin                            -> dump.json
+    python trace_to_chrome.py dump.bin out.json
+
+A file may also be a Serial capture of {"command":"trace"}: the JSON header
+line before the dump is skipped.
+"""
+
+import json
+import os
+import struct
+import sys
+import urllib.request
+
+HEADER = struct.Struct("<4sHHII")  # magic, version, event size, count, lost
+EVENT = struct.Struct("<IBBH")     # micros, type, phase, arg
+
+# Keep in sync with TraceType in esp32/trace.h
+EVENT_NAMES = {
+    1: "input",
+    2: "processInput",
+    3: "dirty",
+    4: "drawStatus",
+    5: "pushSprite",
+    6: "wsConnect",
+    7: "wsDisconnect",
+}
+SOURCES = ["serial", "http", "websocket", "udp", "websocket-lan"]
+DIRTY_FLAGS = [(0x01, "redraw"), (0x02, "character"), (0x04, "status"), (0x08, "info")]
+PUSH_TARGETS = ["character", "frame"]
+
+
+def read_dump(source):
+    """Read the dump from a URL or file, skipping a Serial header line."""
+    if source.startswith("http://") or source.startswith("https://"):
+        with urllib.request.urlopen(source, timeout=10) as response:
+            data = response.read()
+    else:
+        with open(source, "rb") as f:
+            data = f.read()
+
+    start = data.find(b"VMTR")
+    if start < 0:
+        raise ValueError("No trace dump found (missing VMTR header)")
+    return data[start:]
+
+
+def parse_dump(data):
+    """Return (events, lost). Events are (us, type, phase, arg) tuples."""
+    magic, version, event_size, count, lost = HEADER.unpack_from(data, 0)
+    if version != 1 or event_size != EVENT.size:
+        raise ValueError(f"Unsupported trace version {version} (event size {event_size})")
+    if len(data) < HEADER.size + count * EVENT.size:
+        raise ValueError(f"Truncated dump: {count} events expected")
+
+    events = [EVENT.unpack_from(data, HEADER.size + i * EVENT.size) for i in range(count)]
+    return events, lost
+
+
+def event_args(event_type, arg):
+    """Decode the event argument for display."""
+    if event_type in (1, 2):
+        return {"source": SOURCES[arg] if arg < len(SOURCES) else arg}
+    if event_type == 3:
+        return {"flags": [name for bit, name in DIRTY_FLAGS if arg & bit]}
+    if event_type == 5:
+        return {"target": PUSH_TARGETS[arg] if arg < len(PUSH_TARGETS) else arg}
+    return {}
+
+
+def to_chrome(events, lost):
+    """Convert events to a Chrome trace_event document."""
+    trace_events = []
+    open_spans = {}
+    base = None
+    offset = 0
+    previous = None
+
+    for us, event_type, phase, arg in events:
+        # micros() wraps every ~71 minutes
+        if previous is not None and us < previous:
+            offset += 1 << 32
+        previous = us
+        ts = us + offset
+        if base is None:
+            base = ts
+
+        phase = chr(phase)
+        # Spans cut by the ring: drop an end whose begin was overwritten
+        if phase == "B":
+            open_spans[event_type] = open_spans.get(event_type, 0) + 1
+        elif phase == "E":
+            if open_spans.get(event_type, 0) == 0:
+                continue
+            open_spans[event_type] -= 1
+
+        event = {
+            "name": EVENT_NAMES.get(event_type, f"type{event_type}"),
+            "ph": phase,
+            "ts": ts - base,
+            "pid": 1,
+            "tid": 1,
+        }
+        if phase == "i":
+            event["s"] = "t"
+        args = event_args(event_type, arg)
+        if args and phase != "E":
+            event["args"] = args
+        trace_events.append(event)
+
+    return {
+        "traceEvents": trace_events,
+        "displayTimeUnit": "ms",
+        "otherData": {"device": "VibeMon ESP32", "lostEvents": lost},
+    }
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    source = sys.argv[1]
+    if len(sys.argv) > 2:
+        output = sys.argv[2]
+    elif source.startswith("http"):
+        output = "trace.json"
+    else:
+        output = os.path.splitext(source)[0] + ".json"
+
+    events, lost = parse_dump(read_dump(source))
+    with open(output, "w") as f:
+        json.dump(to_chrome(events, lost), f)
+    print(f"{len(events)} events ({lost} lost) -> {output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""
+ESP32 UDP Status Sender
+Sends one status update to a VibeMon ESP32 as a single UDP datagram (firmware
+built with USE_UDP). Meant for hooks: no connection to set up, nothing to
+wait for unless --ack is given.
+
+Usage:
+    python udp_status.py 192.168.0.185 --state working --project vibemon --tool Bash
+    python udp_status.py 192.168.0.185 --state done --project vibemon --compact --copies 2
+    python udp_status.py 192.168.0.185 --state thinking --project vibemon --secret s3cret --ack
+    python udp_status.py 192.168.0.185 --plain --state idle --project vibemon
+
+Datagrams are framed with a sequence number (milliseconds since the epoch by
+default) and a sender ID (a hash of the project name by default). The device
+drops copies that arrive late or twice, so --copies can repeat an update on a
+lossy network safely. --secret (or VIBEMON_UDP_SECRET) adds the HMAC tag that
+firmware built with UDP_SECRET requires. --ack waits for the device's reply
+and resends the same datagram on timeout. --plain sends the bare JSON body
+(no sequence number, no ack).
+"""
+
+import argparse
+import hashlib
+import hmac
+import json
+import os
+import socket
+import struct
+import sys
+import time
+import zlib
+
+DEFAULT_PORT = 19280
+
+# Compact state codes: AppState order in esp32/sprites.h
+STATES = ["start", "idle", "thinking", "planning", "working",
+          "packing", "notification", "done", "sleep", "alert"]
+
+VERSION = 1
+FLAG_ACK = 0x01
+FLAG_COMPACT = 0x02
+FLAG_TAGGED = 0x04
+TAG_SIZE = 8
+
+
+# =============================================================================
+# Datagrams
+# =============================================================================
+
+def json_body(status):
+    return json.dumps(status, separators=(",", ":")).encode()
+
+
+def compact_body(status):
+    """state u8, memory u8 (255 = not sent), then NUL-separated strings."""
+    memory = status.get("memory")
+    body = struct.pack("<BB", STATES.index(status["state"]), 255 if memory is None else memory)
+    fields = [status.get(key, "") for key in ("project", "tool", "model")]
+    while fields and not fields[-1]:
+        fields.pop()  # Trailing empty strings can be left out
+    return body + b"\0".join(f.encode() for f in fields)
+
+
+def frame(body, seq, sender, flags, secret=None):
+    """Framed datagram: "VM", version, flags, seq, sender, body, optional tag."""
+    if secret:
+        flags |= FLAG_TAGGED
+    data = b"VM" + struct.pack("<BBII", VERSION, flags, seq, sender) + body
+    if secret:
+        data += hmac.new(secret.encode(), data, hashlib.sha256).digest()[:TAG_SIZE]
+    return data
+
+
+def default_seq():
+    """Milliseconds since the epoch, 32 bits: increases across hook processes."""
+    return (int(time.time() * 1000) & 0xFFFFFFFF) or 1
+
+
+# =============================================================================
+# Sending
+# =============================================================================
+
+def send(host, port, data, copies, ack_timeout=None, retries=0):
+    """Send the datagram. With ack_timeout, return the reply (None if none came)."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        for attempt in range(retries + 1):
+            for _ in range(copies):
+                sock.sendto(data, (host, port))
+            if ack_timeout is None:
+                return None
+            sock.settimeout(ack_timeout)
+            try:
+                reply, _ = sock.recvfrom(512)
+                return json.loads(reply)
+            except socket.timeout:
+                continue
+        return None
+    finally:
+        sock.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Send a VibeMon status update over UDP")
+    parser.add_argument("host", help="device IP address")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help=f"UDP port (default {DEFAULT_PORT})")
+    parser.add_argument("--state", required=True, choices=STATES)
+    parser.add_argument("--project", default="")
+    parser.add_argument("--tool", default="")
+    parser.add_argument("--model", default="")
+    parser.add_argument("--memory", type=int, choices=range(101), metavar="0-100")
+    parser.add_argument("--compact", action="store_true", help="compact binary body instead of JSON")
+    parser.add_argument("--plain", action="store_true", help="bare JSON datagram, not framed")
+    parser.add_argument("--seq", type=int, help="sequence number (default: ms since the epoch)")
+    parser.add_argument("--sender", type=int, help="sender ID (default: hash of the project name)")
+    parser.add_argument("--secret", default=os.environ.get("VIBEMON_UDP_SECRET"),
+                        help="shared secret (default: $VIBEMON_UDP_SECRET)")
+    parser.add_argument("--copies", type=int, default=1, help="send each datagram this many times")
+    parser.add_argument("--ack", action="store_true", help="wait for the device's reply")
+    parser.add_argument("--timeout", type=float, default=0.5, help="ack timeout in seconds (default 0.5)")
+    parser.add_argument("--retries", type=int, default=3, help="resends without an ack (default 3)")
+    args = parser.parse_args()
+
+    status = {"state": args.state}
+    for key in ("project", "tool", "model"):
+        if getattr(args, key):
+            status[key] = getattr(args, key)
+    if args.memory is not None:
+        status["memory"] = args.memory
+
+    if args.plain:
+        if args.compact or args.ack or args.secret:
+            parser.error("--plain cannot be combined with --compact, --ack or --secret")
+        data = json_body(status)
+    else:
+        seq = args.seq if args.seq is not None else default_seq()
+        sender = args.sender if args.sender is not None else zlib.crc32(args.project.encode())
+        flags = (FLAG_ACK if args.ack else 0) | (FLAG_COMPACT if args.compact else 0)
+        body = compact_body(status) if args.compact else json_body(status)
+        data = frame(body, seq & 0xFFFFFFFF, sender & 0xFFFFFFFF, flags, args.secret)
+
+    if not args.ack:
+        send(args.host, args.port, data, max(1, args.copies))
+        return
+    reply = send(args.host, args.port, data, max(1, args.copies), args.timeout, args.retries)
+    if reply is None:
+        print(json.dumps({"error": "no ack"}))
+        sys.exit(1)
+    print(json.dumps(reply))
+    # "stale": a copy of this update (or a newer one) was already taken
+    sys.exit(0 if reply.get("result") in ("applied", "stale") else 1)
+
+
+if __name__ == "__main__":
+    main()
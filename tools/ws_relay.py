@@ -0,0 +1,450 @@
+#!/usr/bin/env python3
+"""
+VibeMon WebSocket Relay Stand-in
+Local replacement for the cloud relay that ESP32 firmware built with
+USE_WEBSOCKET connects to, for reconnect and soak testing. Speaks plain ws://
+(set WS_HOST to this machine, WS_PORT, and WS_USE_SSL false in credentials.h,
+or run the host soak harness in esp32/host), pushes a status update every
+--interval seconds and injects faults:
+
+    --latency/--jitter   delay every frame, both directions (ms)
+    --drop-every S       abort the connection (mean interval, randomized)
+    --half-open-every S  go silent without closing: frames from the device
+                         are discarded and nothing is sent, the TCP
+                         connection stays up until the device gives up
+    --auth-error P       reject a handshake with 401, probability P
+    --outage-every S     stop listening for --outage-for seconds (connects
+                         are refused: exercises the firmware's forced re-init)
+
+Usage:
+    python ws_relay.py --port 8765 --token soak
+    python ws_relay.py --latency 40 --jitter 20 --drop-every 120 --half-open-every 300
+    python ws_relay.py --auth-error 0.05 --outage-every 900 --outage-for 150 --seed 7
+
+With --token, a handshake without ?token=<token> gets 401 (as the cloud
+relay's connect authorizer) and an auth message with another token is
+answered with close code 1008. Status updates carry "eventId":"soak-N", N
+counting up for the whole run (also while no device is connected), so the
+receiver can count what it lost. Events are printed as JSON lines
+(--quiet: none); the summary, with the time from each fault to the next
+completed handshake, on exit (Ctrl+C, SIGTERM or --duration).
+"""
+
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import random
+import signal
+import struct
+import sys
+import time
+from urllib.parse import parse_qs, urlsplit
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+OP_TEXT = 0x1
+OP_CLOSE = 0x8
+OP_PING = 0x9
+OP_PONG = 0xA
+
+# Pushed in turn: a session that thinks, uses tools and finishes
+STATUS_CYCLE = [
+    {"state": "thinking"},
+    {"state": "working", "tool": "Bash"},
+    {"state": "working", "tool": "Read"},
+    {"state": "working", "tool": "Edit"},
+    {"state": "done"},
+]
+
+
+# =============================================================================
+# Statistics
+# =============================================================================
+
+class Stats:
+    def __init__(self):
+        self.started = time.monotonic()
+        self.connections = 0
+        self.auth_rejected = 0      # 401 at the handshake
+        self.auth_closed = 0        # Closed after a wrong auth message
+        self.faults = {"drop": 0, "halfOpen": 0, "outage": 0, "authError": 0}
+        self.recovery_ms = {kind: [] for kind in self.faults}
+        self.pending_fault = None   # (kind, time): waiting for the next handshake
+        self.pings = 0
+        self.sent = 0               # Status updates written to a live connection
+        self.undelivered = 0        # Generated while no device was connected
+        self.swallowed = 0          # Written into a half-open connection
+        self.in_flight_lost = 0     # Queued (latency) when the connection went away
+
+    def fault(self, kind):
+        self.faults[kind] += 1
+        if self.pending_fault is None:
+            self.pending_fault = (kind, time.monotonic())
+
+    def recovered(self):
+        """Handshake completed: ms since the fault that broke the last one."""
+        if self.pending_fault is None:
+            return None
+        kind, at = self.pending_fault
+        self.pending_fault = None
+        ms = int((time.monotonic() - at) * 1000)
+        self.recovery_ms[kind].append(ms)
+        return ms
+
+    def summary(self):
+        def dist(samples):
+            if not samples:
+                return {"count": 0}
+            ordered = sorted(samples)
+            pick = lambda pct: ordered[min(len(ordered) - 1, len(ordered) * pct // 100)]
+            return {"count": len(ordered), "p50": pick(50), "p95": pick(95), "max": ordered[-1]}
+
+        return {"summary": {
+            "seconds": round(time.monotonic() - self.started, 1),
+            "connections": self.connections,
+            "authRejected": self.auth_rejected,
+            "authClosed": self.auth_closed,
+            "faults": self.faults,
+            "recoveryMs": {kind: dist(samples) for kind, samples in self.recovery_ms.items()},
+            "pings": self.pings,
+            "messages": {"sent": self.sent, "undelivered": self.undelivered,
+                         "swallowed": self.swallowed, "inFlightLost": self.in_flight_lost},
+        }}
+
+
+# =============================================================================
+# Framing (RFC 6455)
+# =============================================================================
+
+def encode_frame(opcode, payload=b""):
+    """Server frames are not masked."""
+    head = bytes([0x80 | opcode])
+    n = len(payload)
+    if n < 126:
+        head += bytes([n])
+    elif n < 65536:
+        head += bytes([126]) + struct.pack(">H", n)
+    else:
+        head += bytes([127]) + struct.pack(">Q", n)
+    return head + payload
+
+
+async def read_frame(reader):
+    """(fin, opcode, payload) of the next frame from the device (masked)."""
+    b0, b1 = await reader.readexactly(2)
+    length = b1 & 0x7F
+    if length == 126:
+        (length,) = struct.unpack(">H", await reader.readexactly(2))
+    elif length == 127:
+        (length,) = struct.unpack(">Q", await reader.readexactly(8))
+    mask = await reader.readexactly(4) if b1 & 0x80 else None
+    payload = await reader.readexactly(length)
+    if mask:
+        payload = bytes(b ^ mask[i & 3] for i, b in enumerate(payload))
+    return b0 & 0x80, b0 & 0x0F, payload
+
+
+# =============================================================================
+# Relay
+# =============================================================================
+
+class Connection:
+    def __init__(self, relay, writer, peer):
+        self.relay = relay
+        self.writer = writer
+        self.peer = peer
+        self.half_open = False
+        self.outbox = asyncio.Queue()    # (due, frame, is_status)
+        self.last_due = 0.0
+        self.sender = asyncio.ensure_future(self.send_loop())
+
+    def send(self, frame, is_status=False):
+        """Queue a frame, delivered after the injected latency (in order)."""
+        due = max(self.last_due, time.monotonic() + self.relay.delay())
+        self.last_due = due
+        self.outbox.put_nowait((due, frame, is_status))
+
+    async def send_loop(self):
+        while True:
+            due, frame, is_status = await self.outbox.get()
+            wait = due - time.monotonic()
+            if wait > 0:
+                await asyncio.sleep(wait)
+            if self.half_open:
+                if is_status:
+                    self.relay.stats.swallowed += 1
+                continue
+            if self.writer.transport.is_closing():
+                if is_status:
+                    self.relay.stats.in_flight_lost += 1
+                continue
+            try:
+                self.writer.write(frame)
+                await self.writer.drain()
+            except (ConnectionError, OSError):
+                return
+            if is_status:
+                self.relay.stats.sent += 1
+
+    def abort(self):
+        self.writer.transport.abort()
+
+    def finish(self):
+        """Connection gone: count the status updates still waiting out the latency."""
+        self.sender.cancel()
+        while not self.outbox.empty():
+            if self.outbox.get_nowait()[2]:
+                self.relay.stats.in_flight_lost += 1
+
+
+class Relay:
+    def __init__(self, args):
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.stats = Stats()
+        self.connections = set()
+        self.server = None
+        self.seq = 0
+
+    def log(self, event, **fields):
+        if self.args.quiet:
+            return
+        line = {"t": round(time.monotonic() - self.stats.started, 3), "event": event}
+        line.update(fields)
+        print(json.dumps(line), flush=True)
+
+    def delay(self):
+        """One-way latency for the next frame (seconds)."""
+        ms = self.args.latency + (self.rng.uniform(-self.args.jitter, self.args.jitter) if self.args.jitter else 0)
+        return max(0.0, ms) / 1000
+
+    def live(self):
+        return [conn for conn in self.connections if not conn.half_open]
+
+    # -------------------------------------------------------------------------
+    # Listening
+    # -------------------------------------------------------------------------
+
+    async def listen(self):
+        self.server = await asyncio.start_server(self.handle, self.args.host, self.args.port)
+
+    async def stop_listening(self):
+        self.server.close()
+        await self.server.wait_closed()
+        self.server = None
+
+    # -------------------------------------------------------------------------
+    # Connections
+    # -------------------------------------------------------------------------
+
+    async def handshake(self, reader, writer, peer):
+        """Answer the upgrade request; False if rejected."""
+        try:
+            request = await asyncio.wait_for(reader.readuntil(b"\r\n\r\n"), 10)
+        except (asyncio.TimeoutError, asyncio.IncompleteReadError, asyncio.LimitOverrunError):
+            return False
+        lines = request.decode("latin-1").split("\r\n")
+        parts = lines[0].split(" ")
+        headers = {}
+        for line in lines[1:]:
+            if ":" in line:
+                name, value = line.split(":", 1)
+                headers[name.strip().lower()] = value.strip()
+        path = parts[1] if len(parts) > 1 else "/"
+        token = parse_qs(urlsplit(path).query).get("token", [""])[0]
+
+        await asyncio.sleep(self.delay())
+        key = headers.get("sec-websocket-key")
+        if not key:
+            writer.write(b"HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n")
+            return False
+        injected = self.rng.random() < self.args.auth_error
+        if injected or (self.args.token and token != self.args.token):
+            writer.write(b"HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\n\r\n")
+            self.stats.auth_rejected += 1
+            if injected:
+                self.stats.fault("authError")
+            self.log("auth_rejected", peer=peer, injected=injected)
+            return False
+
+        accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        response = ("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                    f"Sec-WebSocket-Accept: {accept}\r\n")
+        if "sec-websocket-protocol" in headers:
+            response += f"Sec-WebSocket-Protocol: {headers['sec-websocket-protocol'].split(',')[0].strip()}\r\n"
+        writer.write((response + "\r\n").encode())
+        return True
+
+    async def handle(self, reader, writer):
+        peer = "%s:%d" % writer.get_extra_info("peername")[:2]
+        if not await self.handshake(reader, writer, peer):
+            writer.close()
+            return
+
+        conn = Connection(self, writer, peer)
+        self.connections.add(conn)
+        self.stats.connections += 1
+        self.log("connected", peer=peer, recoveryMs=self.stats.recovered())
+        reason = "closed"
+        try:
+            while True:
+                fin, opcode, payload = await read_frame(reader)
+                await asyncio.sleep(self.delay())
+                if conn.half_open:
+                    continue  # Dead path: nothing reaches the relay
+                if opcode == OP_PING:
+                    self.stats.pings += 1
+                    conn.send(encode_frame(OP_PONG, payload))
+                elif opcode == OP_TEXT:
+                    if not self.on_text(conn, payload):
+                        reason = "auth_failed"
+                        break
+                elif opcode == OP_CLOSE:
+                    conn.send(encode_frame(OP_CLOSE, payload[:2]))
+                    reason = "close"
+                    break
+        except (asyncio.IncompleteReadError, ConnectionError, OSError):
+            reason = "reset" if not conn.half_open else "closed_half_open"
+        finally:
+            if reason in ("close", "auth_failed"):
+                # Let the queued close frame out first
+                await asyncio.sleep(max(0.0, conn.last_due - time.monotonic()) + 0.01)
+            self.connections.discard(conn)
+            conn.finish()
+            writer.close()
+            self.log("disconnected", peer=peer, reason=reason)
+
+    def on_text(self, conn, payload):
+        """Device message; False to drop the connection (wrong token)."""
+        try:
+            message = json.loads(payload)
+        except ValueError:
+            return True
+        if isinstance(message, dict) and message.get("type") == "auth":
+            if self.args.token and message.get("token") != self.args.token:
+                self.stats.auth_closed += 1
+                self.log("auth_failed", peer=conn.peer)
+                conn.send(encode_frame(OP_CLOSE, struct.pack(">H", 1008)))
+                return False
+            self.log("auth_ok", peer=conn.peer)
+        return True
+
+    # -------------------------------------------------------------------------
+    # Status Updates and Faults
+    # -------------------------------------------------------------------------
+
+    async def push_statuses(self):
+        while True:
+            await asyncio.sleep(self.args.interval)
+            self.seq += 1
+            status = dict(STATUS_CYCLE[self.seq % len(STATUS_CYCLE)])
+            status.update(project="soak", eventId=f"soak-{self.seq}")
+            frame = encode_frame(OP_TEXT, json.dumps(status, separators=(",", ":")).encode())
+            if not self.connections:
+                self.stats.undelivered += 1
+            for conn in self.connections:
+                conn.send(frame, is_status=True)
+
+    async def every(self, mean_seconds, inject):
+        """Call inject() at random intervals averaging mean_seconds."""
+        while True:
+            await asyncio.sleep(self.rng.expovariate(1 / mean_seconds))
+            await inject()
+
+    async def inject_drop(self):
+        for conn in self.live():
+            self.stats.fault("drop")
+            self.log("fault", kind="drop", peer=conn.peer)
+            conn.abort()
+
+    async def inject_half_open(self):
+        for conn in self.live():
+            self.stats.fault("halfOpen")
+            self.log("fault", kind="half_open", peer=conn.peer)
+            conn.half_open = True
+
+    async def inject_outage(self):
+        self.stats.fault("outage")
+        self.log("fault", kind="outage", seconds=self.args.outage_for)
+        await self.stop_listening()
+        for conn in list(self.connections):
+            conn.abort()
+        await asyncio.sleep(self.args.outage_for)
+        await self.listen()
+        self.log("outage_over")
+
+    async def run(self, stop):
+        await self.listen()
+        self.log("listening", host=self.args.host, port=self.args.port)
+        tasks = []
+        if self.args.interval > 0:
+            tasks.append(self.push_statuses())
+        if self.args.drop_every > 0:
+            tasks.append(self.every(self.args.drop_every, self.inject_drop))
+        if self.args.half_open_every > 0:
+            tasks.append(self.every(self.args.half_open_every, self.inject_half_open))
+        if self.args.outage_every > 0:
+            tasks.append(self.every(self.args.outage_every, self.inject_outage))
+        running = [asyncio.ensure_future(task) for task in tasks]
+        await stop.wait()
+        for task in running:
+            task.cancel()
+        if self.server:
+            await self.stop_listening()
+        for conn in list(self.connections):
+            conn.abort()
+
+
+# =============================================================================
+# Main
+# =============================================================================
+
+async def serve(args):
+    relay = Relay(args)
+    stop = asyncio.Event()
+    loop = asyncio.get_running_loop()
+    for sig in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(sig, stop.set)
+    if args.duration > 0:
+        loop.call_later(args.duration, stop.set)
+    await relay.run(stop)
+    print(json.dumps(relay.stats.summary()), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local VibeMon WebSocket relay with fault injection")
+    parser.add_argument("--host", default="0.0.0.0", help="listen address (default 0.0.0.0)")
+    parser.add_argument("--port", type=int, default=8765, help="listen port (default 8765)")
+    parser.add_argument("--token", default="", help="required token (URL and auth message)")
+    parser.add_argument("--interval", type=float, default=1.0,
+                        help="seconds between status updates (0: none, default 1)")
+    parser.add_argument("--latency", type=float, default=0, help="one-way delay per frame (ms)")
+    parser.add_argument("--jitter", type=float, default=0, help="random +/- added to --latency (ms)")
+    parser.add_argument("--drop-every", type=float, default=0, metavar="S",
+                        help="abort the connection every S seconds on average")
+    parser.add_argument("--half-open-every", type=float, default=0, metavar="S",
+                        help="go silent (connection left open) every S seconds on average")
+    parser.add_argument("--auth-error", type=float, default=0, metavar="P",
+                        help="probability of rejecting a handshake with 401")
+    parser.add_argument("--outage-every", type=float, default=0, metavar="S",
+                        help="stop listening every S seconds on average")
+    parser.add_argument("--outage-for", type=float, default=150, metavar="S",
+                        help="outage length (default 150: past the firmware's 120s re-init)")
+    parser.add_argument("--duration", type=float, default=0, help="stop after this many seconds")
+    parser.add_argument("--seed", type=int, help="random seed (repeatable fault schedule)")
+    parser.add_argument("--quiet", action="store_true", help="print only the summary")
+    args = parser.parse_args()
+    if not 0 <= args.auth_error <= 1:
+        parser.error("--auth-error is a probability (0-1)")
+
+    try:
+        asyncio.run(serve(args))
+    except OSError as e:
+        print(json.dumps({"error": str(e)}), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()